@@ -0,0 +1,186 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "core.h"
+
+// The default number of cycles a CPU can run ahead of the other
+#define DEFAULT_WINDOW 256
+
+// The CPU run by the current thread, or -1 for threads like the renderers that aren't running one
+static thread_local int cpuThread = -1;
+
+Arm7Thread::~Arm7Thread() {
+    // Stop the worker thread if it was started
+    if (!thread.joinable()) return;
+    mutex.lock();
+    stopping = true;
+    cond.notify_one();
+    mutex.unlock();
+    thread.join();
+}
+
+void Arm7Thread::init(uint32_t romCode) {
+    // Get the game code from the ROM header as a string
+    char code[5] = {};
+    for (int i = 0; i < 4; i++)
+        code[i] = romCode >> (i * 8);
+
+    // Enable the threaded ARM7 for all games or only listed ones, depending on the setting
+    // It's never used with an HLE ARM7 or in DSi mode, which have their own run functions
+    if (core->arm7Hle || core->dsiMode)
+        enabled = false;
+    else if (Settings::arm7Thread == 2)
+        enabled = true;
+    else if (Settings::arm7Thread == 1)
+        enabled = (romCode && Settings::arm7ThreadGames.find(code) != std::string::npos);
+    else
+        enabled = false;
+
+    if (enabled)
+        LOG_INFO("Running the ARM7 on a separate thread for game %s\n", code);
+}
+
+void Arm7Thread::startWindow() {
+    // Start the worker thread the first time it's needed, and wake it up if it's sleeping
+    if (!thread.joinable())
+        thread = std::thread(&Arm7Thread::runWorker, this);
+    if (!session.load()) {
+        mutex.lock();
+        session.store(true);
+        cond.notify_one();
+        mutex.unlock();
+    }
+
+    // Reset synchronization state and publish where both CPUs start
+    window = Settings::cpuQuantum ? Settings::cpuQuantum : DEFAULT_WINDOW;
+    nextEvent.store(core->events[0].cycles);
+    for (int i = 0; i < 2; i++) {
+        time[i].store(core->interpreter[i].getCycles());
+        pauseReq[i].store(false);
+        parked[i].store(false);
+        done[i].store(false);
+        depth[i] = 0;
+    }
+
+    // Let both CPUs run until the next scheduled task, with this thread running the ARM9
+    cpuThread = 0;
+    active.store(true);
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+void Arm7Thread::finishWindow() {
+    // Wait for the ARM7 to also reach the next scheduled task
+    // The ARM9 counts as parked here, so the ARM7 can still get exclusive access in the meantime
+    parked[0].store(true);
+    done[0].store(true);
+    while (!done[1].load(std::memory_order_acquire))
+        std::this_thread::yield();
+    active.store(false);
+    cpuThread = -1;
+}
+
+void Arm7Thread::endSession() {
+    // Let the worker thread go to sleep once it finishes spinning for windows
+    session.store(false);
+}
+
+void Arm7Thread::runWorker() {
+    std::unique_lock<std::mutex> guard(mutex);
+    uint32_t last = generation.load();
+    cpuThread = 1;
+
+    while (true) {
+        // Sleep until the threaded run function is in use
+        cond.wait(guard, [&] { return session.load() || stopping; });
+        if (stopping) return;
+        guard.unlock();
+
+        // Spin for new windows while in use, since they only last until the next scheduled task
+        while (session.load()) {
+            uint32_t current = generation.load(std::memory_order_acquire);
+            if (current == last) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Run the ARM7 through the window and wait at the end for the ARM9
+            last = current;
+            Interpreter::runThreaded<true>(*core);
+            parked[1].store(true);
+            done[1].store(true, std::memory_order_release);
+        }
+
+        guard.lock();
+    }
+}
+
+bool Arm7Thread::lock() {
+    // Only lock for the CPU threads, since other threads like the renderers don't take part in the timing
+    // Allow nested accesses from a CPU that already has exclusive access
+    if (cpuThread < 0) return false;
+    bool arm7 = cpuThread;
+    if (depth[arm7]++) return true;
+
+    // Wait until the other CPU catches up, so shared state is accessed in timestamp order
+    // On a tie the ARM9 goes first, so the CPU that's behind can always continue
+    uint32_t cycles = core->interpreter[arm7].getCycles();
+    wait(arm7, [&] {
+        return !done[!arm7].load() && int32_t(time[!arm7].load(std::memory_order_acquire) - cycles) < int32_t(arm7);
+    });
+
+    // Pause the other CPU at an opcode boundary, and time accesses from this CPU's cycle count
+    pauseReq[!arm7].store(true);
+    while (!parked[!arm7].load())
+        std::this_thread::yield();
+    core->globalCycles = cycles;
+    return true;
+}
+
+void Arm7Thread::unlock() {
+    // Release exclusive access once the outermost access is finished
+    bool arm7 = cpuThread;
+    if (--depth[arm7]) return;
+
+    // Let both CPUs stop at any newly scheduled task, and resume the other CPU
+    nextEvent.store(core->events[0].cycles, std::memory_order_release);
+    pauseReq[!arm7].store(false);
+}
+
+void Arm7Thread::hold(bool arm7, uint32_t cycles) {
+    // Wait while the other CPU has exclusive access, or while this one is a window ahead of it
+    wait(arm7, [&] {
+        return !done[!arm7].load() && int32_t(cycles - time[!arm7].load(std::memory_order_acquire)) >= window;
+    });
+}
+
+template <typename F> void Arm7Thread::wait(bool arm7, F blocked) {
+    // Wait as parked, so the other CPU knows it can take exclusive access
+    parked[arm7].store(true);
+    while (true) {
+        if (blocked() || pauseReq[arm7].load()) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Unpark, but check again for a pause request that may have raced with it
+        parked[arm7].store(false);
+        if (!pauseReq[arm7].load()) return;
+        parked[arm7].store(true);
+    }
+}
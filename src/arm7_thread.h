@@ -0,0 +1,91 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "defines.h"
+
+class Core;
+
+class Arm7Thread {
+public:
+    bool enabled = false;
+
+    Arm7Thread(Core *core): core(core) {}
+    ~Arm7Thread();
+
+    void init(uint32_t romCode);
+    void startWindow();
+    void finishWindow();
+    void endSession();
+
+    bool enter() { return active.load(std::memory_order_relaxed) && lock(); }
+    void leave() { unlock(); }
+
+    bool canRun(bool arm7, uint32_t cycles);
+    void publish(bool arm7, uint32_t cycles) { time[arm7].store(cycles, std::memory_order_release); }
+
+private:
+    Core *core;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool stopping = false;
+    int32_t window = 0;
+
+    std::atomic<bool> active = { false };
+    std::atomic<bool> session = { false };
+    std::atomic<uint32_t> generation = { 0 };
+    std::atomic<uint32_t> nextEvent = { 0 };
+    std::atomic<uint32_t> time[2] = {};
+    std::atomic<bool> pauseReq[2] = {};
+    std::atomic<bool> parked[2] = {};
+    std::atomic<bool> done[2] = {};
+    int depth[2] = {};
+
+    void runWorker();
+    bool lock();
+    void unlock();
+    void hold(bool arm7, uint32_t cycles);
+    template <typename F> void wait(bool arm7, F blocked);
+};
+
+class Arm7Lock {
+public:
+    Arm7Lock(Arm7Thread &thread): thread(thread), locked(thread.enter()) {}
+    ~Arm7Lock() { if (locked) thread.leave(); }
+
+private:
+    Arm7Thread &thread;
+    bool locked;
+};
+
+FORCE_INLINE bool Arm7Thread::canRun(bool arm7, uint32_t cycles) {
+    // Hold a CPU at an opcode boundary if the other has exclusive access, or if it's too far ahead
+    if (pauseReq[arm7].load() || int32_t(cycles - time[!arm7].load(std::memory_order_acquire)) >= window)
+        hold(arm7, cycles);
+
+    // Let the CPU run until the next scheduled task
+    return int32_t(cycles - nextEvent.load(std::memory_order_acquire)) < 0;
+}
@@ -0,0 +1,169 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+#include "../core.h"
+
+// Where the guest loops store their iteration counts
+#define COUNTER9 0x2200000
+#define COUNTER7 0x380F000
+
+// ARM9 loop in ARM mode, with 7 instructions per iteration
+static const uint32_t arm9Code[] = {
+    0xE3A00000, // mov r0,#0
+    0xE59F1018, // ldr r1,=COUNTER9
+    0xE2800001, // loop: add r0,r0,#1
+    0xE0822000, // add r2,r2,r0
+    0xE1520000, // cmp r2,r0
+    0x13A03001, // movne r3,#1
+    0xE5810000, // str r0,[r1]
+    0xE5914000, // ldr r4,[r1]
+    0xEAFFFFF8, // b loop
+    COUNTER9
+};
+
+// ARM7 loop in THUMB mode, with 6 instructions per iteration
+static const uint16_t arm7Code[] = {
+    0x0001, 0xE28F, // add r0,pc,#1
+    0xFF10, 0xE12F, // bx r0
+    0x2000, // mov r0,#0
+    0x4903, // ldr r1,=COUNTER7
+    0x3001, // loop: add r0,#1
+    0x1882, // add r2,r0,r2
+    0x4282, // cmp r2,r0
+    0x6008, // str r0,[r1]
+    0x680B, // ldr r3,[r1]
+    0xE7F9, // b loop
+    COUNTER7 & 0xFFFF, COUNTER7 >> 16
+};
+
+void writeRom(const char *path, const void *arm9Code, size_t size9, const void *arm7Code, size_t size7) {
+    // Build a small ROM that runs code on both CPUs when booted directly
+    uint8_t rom[0x1000] = {};
+    uint32_t header[] = { 0x200, 0x2000000, 0x2000000, uint32_t(size9), 0x400, 0x3800000, 0x3800000, uint32_t(size7) };
+    memcpy(&rom[0x20], header, sizeof(header));
+    memcpy(&rom[0x200], arm9Code, size9);
+    memcpy(&rom[0x400], arm7Code, size7);
+
+    // Write the ROM to a file so the core can load it
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        printf("Failed to write %s\n", path);
+        exit(1);
+    }
+    fwrite(rom, sizeof(uint8_t), sizeof(rom), file);
+    fclose(file);
+}
+
+int main(int argc, char **argv) {
+    // Run without throttling or extra threads so only emulation time is measured
+    Settings::directBoot = 1;
+    Settings::fpsLimiter = 0;
+    Settings::framePacer = 0;
+    Settings::threaded2D = 0;
+    Settings::threaded3D = 0;
+    Settings::savesFolder = 0;
+    Settings::statesFolder = 0;
+    Settings::cheatsFolder = 0;
+
+    // Run the microbenchmark suite, golden-frame harness, ROM sweep, or quantum comparison instead if requested
+    if (argc > 1 && !strcmp(argv[1], "micro"))
+        return runMicro(argc - 2, argv + 2);
+    if (argc > 1 && !strcmp(argv[1], "golden"))
+        return runGolden(argv[0], argc - 2, argv + 2);
+    if (argc > 1 && !strcmp(argv[1], "sweep"))
+        return runSweep(argv[0], argc - 2, argv + 2);
+    if (argc > 1 && !strcmp(argv[1], "quantum"))
+        return runQuantum(argc - 2, argv + 2);
+
+    // Parse the frame count and ROM path, generating the synthetic ROM if none is given
+    int frames = (argc > 1) ? atoi(argv[1]) : 600;
+    std::string path = (argc > 2) ? argv[2] : "bench.nds";
+    bool synthetic = (argc <= 2);
+    if (synthetic)
+        writeRom(path.c_str(), arm9Code, sizeof(arm9Code), arm7Code, sizeof(arm7Code));
+
+    Core *core;
+    try {
+        core = new Core(path);
+    }
+    catch (CoreError e) {
+        printf("Failed to load %s\n", path.c_str());
+        return 1;
+    }
+
+    // Record or play a movie from boot if requested, so runs have identical input
+    // Playback stops early if guest RAM diverges from the recording
+    std::string movie = (argc > 4) ? argv[4] : "";
+    bool recording = (movie != "" && !strcmp(argv[3], "record"));
+    if (movie != "" && !(recording ? core->movie.startRecording(movie) : core->movie.startPlayback(movie))) {
+        printf("Failed to open movie %s\n", movie.c_str());
+        return 1;
+    }
+    if (core->movie.getWarning() != "")
+        printf("Movie: %s\n", core->movie.getWarning().c_str());
+
+    // Warm up for a second before measuring
+    for (int i = 0; i < 60; i++)
+        core->runCore();
+    uint32_t start9 = core->memory.read<uint32_t>(0, COUNTER9);
+    uint32_t start7 = core->memory.read<uint32_t>(1, COUNTER7);
+
+    // Run the requested number of frames as fast as possible
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+        core->runCore();
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+#ifdef DIRECT_DISPATCH
+    printf("Dispatch: direct\n");
+#else
+    printf("Dispatch: member pointer\n");
+#endif
+    printf("Frames: %d in %.3fs (%.1f FPS)\n", frames, time.count(), frames / time.count());
+
+    // Count the instructions run by the synthetic loops
+    if (synthetic) {
+        double arm9 = double(core->memory.read<uint32_t>(0, COUNTER9) - start9) * 7;
+        double arm7 = double(core->memory.read<uint32_t>(1, COUNTER7) - start7) * 6;
+        printf("ARM9: %.2f MIPS\n", arm9 / time.count() / 1000000);
+        printf("ARM7: %.2f MIPS\n", arm7 / time.count() / 1000000);
+        printf("Total: %.2f MIPS\n", (arm9 + arm7) / time.count() / 1000000);
+    }
+
+    // Report whether movie playback stayed in sync, failing if it didn't
+    int result = 0;
+    if (movie != "" && !recording) {
+        if (core->movie.getFailFrame() >= 0) {
+            printf("Movie: desynced at frame %lld (%s)\n", (long long)core->movie.getFailFrame(), core->movie.getFailReason());
+            result = 1;
+        }
+        else {
+            printf("Movie: in sync\n");
+        }
+    }
+
+    delete core;
+    return result;
+}
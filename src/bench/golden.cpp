@@ -0,0 +1,345 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "bench.h"
+#include "../core.h"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+struct Config {
+    const char *name;
+    const char *golden; // The configuration whose golden hashes this one must match
+    int threaded2D;
+    int threaded3D;
+    int highRes3D;
+    int cpuQuantum;
+};
+
+struct Result {
+    uint64_t video;
+    uint32_t audio;
+};
+
+// Threaded configurations must produce the same output as their single-threaded counterparts
+// A CPU quantum of 1 must also match exact interleaving, which it's equivalent to
+static const Config configs[] = {
+    { "native", "native", 0, 0, 0, 0 },
+    { "native-threaded", "native", 1, 4, 0, 0 },
+    { "native-quantum", "native", 0, 0, 0, 1 },
+    { "high-res", "high-res", 0, 0, 1, 0 },
+    { "high-res-threaded", "high-res", 1, 4, 1, 0 }
+};
+
+static uint64_t hashPixels(const std::vector<uint32_t> &pixels) {
+    // Hash a frame with 64-bit FNV-1a over whole pixels
+    uint64_t hash = 0xCBF29CE484222325;
+    for (size_t i = 0; i < pixels.size(); i++)
+        hash = (hash ^ pixels[i]) * 0x100000001B3;
+    return hash;
+}
+
+static bool writePpm(std::string path, const std::vector<uint32_t> &pixels, int width, int height) {
+    // Write RGB8 pixels as a binary PPM image, which most image viewers can open
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> data(width * height * 3);
+    for (int i = 0; i < width * height; i++) {
+        data[i * 3 + 0] = pixels[i] >> 0;
+        data[i * 3 + 1] = pixels[i] >> 8;
+        data[i * 3 + 2] = pixels[i] >> 16;
+    }
+    fwrite(data.data(), sizeof(uint8_t), data.size(), file);
+    fclose(file);
+    return true;
+}
+
+static bool readPpm(std::string path, std::vector<uint32_t> &pixels, int width, int height) {
+    // Read a PPM image written by this harness, checking that it has the expected size
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) return false;
+    int w = 0, h = 0, max = 0;
+    std::vector<uint8_t> data(width * height * 3);
+    bool valid = (fscanf(file, "P6 %d %d %d", &w, &h, &max) == 3 && w == width && h == height && fgetc(file) != EOF
+        && fread(data.data(), sizeof(uint8_t), data.size(), file) == data.size());
+    fclose(file);
+    if (!valid) return false;
+
+    pixels.resize(width * height);
+    for (int i = 0; i < width * height; i++)
+        pixels[i] = 0xFF000000 | (data[i * 3 + 2] << 16) | (data[i * 3 + 1] << 8) | data[i * 3 + 0];
+    return true;
+}
+
+static void writeDiff(std::string path, const std::vector<uint32_t> &golden,
+        const std::vector<uint32_t> &actual, int width, int height) {
+    // Show the golden frame dimmed in grayscale, with pixels that differ highlighted in red
+    std::vector<uint32_t> diff(width * height);
+    for (int i = 0; i < width * height; i++) {
+        if (golden[i] != actual[i]) {
+            diff[i] = 0xFF0000FF;
+            continue;
+        }
+        uint8_t gray = (((golden[i] >> 0) & 0xFF) + ((golden[i] >> 8) & 0xFF) + ((golden[i] >> 16) & 0xFF)) / 9;
+        diff[i] = 0xFF000000 | (gray << 16) | (gray << 8) | gray;
+    }
+    writePpm(path, diff, width, height);
+}
+
+static std::map<int, Result> loadGolden(std::string path) {
+    // Read golden hashes, with a frame number, video hash, and audio hash on each line
+    std::map<int, Result> golden;
+    if (FILE *file = fopen(path.c_str(), "r")) {
+        int frame;
+        unsigned long long video;
+        unsigned int audio;
+        while (fscanf(file, "%d %llx %x", &frame, &video, &audio) == 3)
+            golden[frame] = { video, audio };
+        fclose(file);
+    }
+    return golden;
+}
+
+static std::string getBase(std::string rom, std::string movie) {
+    // Name golden files after the movie, or after the ROM if it runs without input
+    std::string path = (movie != "-") ? movie : rom;
+    size_t dot = path.rfind('.');
+    return (dot != std::string::npos && dot > path.find_last_of("/\\") + 1) ? path.substr(0, dot) : path;
+}
+
+static int runConfig(const Config &config, bool update, std::string rom, std::string movie, std::vector<int> &frames) {
+    // Apply the configuration, disabling anything that would skip or alter frames between runs
+    Settings::threaded2D = config.threaded2D;
+    Settings::threaded3D = config.threaded3D;
+    Settings::highRes3D = config.highRes3D;
+    Settings::cpuQuantum = config.cpuQuantum;
+    Settings::adaptiveRes3D = 0;
+    Settings::frameskip = 0;
+    Settings::adaptiveSkip = 0;
+    Settings::screenGhost = 0;
+    Settings::screenFilter = 0;
+    Settings::emulateAudio = 1;
+
+    Core *core;
+    try {
+        core = new Core(rom);
+    }
+    catch (CoreError e) {
+        printf("error Failed to load %s\n", rom.c_str());
+        return 1;
+    }
+
+    // Replay the movie from boot, so every run sees the same input
+    if (movie != "-" && !core->movie.startPlayback(movie)) {
+        printf("error Failed to open movie %s\n", movie.c_str());
+        delete core;
+        return 1;
+    }
+
+    // Get the golden data this configuration is checked against, unless it's being replaced
+    std::string base = getBase(rom, movie) + "." + config.golden;
+    std::map<int, Result> golden;
+    if (!update) golden = loadGolden(base + ".golden");
+
+    int width = 256 << config.highRes3D, height = 384 << config.highRes3D;
+    std::vector<uint32_t> pixels(width * height), reference;
+    std::string hashes;
+    int failures = 0;
+
+    for (int frame = 0; frame <= frames.back(); frame++) {
+        // Run a frame and take its output; each one must be drained so the next isn't dropped
+        core->runCore();
+        bool drawn = core->gpu.getFrame(pixels.data(), false);
+        uint32_t audio = core->spu.takeSampleHash();
+        if (!std::binary_search(frames.begin(), frames.end(), frame))
+            continue;
+        uint64_t video = drawn ? hashPixels(pixels) : 0;
+        std::string image = base + "." + std::to_string(frame) + ".ppm";
+
+        if (update) {
+            // Save the hashes, along with the frame so future mismatches can be shown
+            char line[64];
+            snprintf(line, sizeof(line), "%d %016llx %08x\n", frame, (unsigned long long)video, audio);
+            hashes += line;
+            writePpm(image, pixels, width, height);
+            printf("golden %d %016llx %08x new\n", frame, (unsigned long long)video, audio);
+            continue;
+        }
+
+        // Compare with the golden hashes, and save the frame with a diff image if it doesn't match
+        std::map<int, Result>::iterator it = golden.find(frame);
+        const char *status = "ok";
+        if (it == golden.end()) {
+            status = "missing";
+        }
+        else if (it->second.video != video) {
+            std::string actual = getBase(rom, movie) + "." + config.name + "." + std::to_string(frame);
+            writePpm(actual + ".actual.ppm", pixels, width, height);
+            if (readPpm(image, reference, width, height))
+                writeDiff(actual + ".diff.ppm", reference, pixels, width, height);
+            status = (it->second.audio != audio) ? "both" : "video";
+        }
+        else if (it->second.audio != audio) {
+            status = "audio";
+        }
+        failures += strcmp(status, "ok") != 0;
+        printf("golden %d %016llx %08x %s\n", frame, (unsigned long long)video, audio, status);
+    }
+
+    // Playback has to stay in sync for the comparison to mean anything
+    if (core->movie.getFailFrame() >= 0) {
+        printf("desync %lld %s\n", (long long)core->movie.getFailFrame(), core->movie.getFailReason());
+        failures++;
+    }
+    delete core;
+
+    // Write the new golden hashes
+    if (update) {
+        FILE *file = fopen((base + ".golden").c_str(), "w");
+        if (!file) {
+            printf("error Failed to write %s.golden\n", base.c_str());
+            return 1;
+        }
+        fputs(hashes.c_str(), file);
+        fclose(file);
+    }
+    return failures ? 1 : 0;
+}
+
+static int runTest(const char *self, bool update, std::string args) {
+    // Run each configuration in its own process, since settings are global, and let them all run in parallel
+    // When updating, only configurations that own golden data are run
+    std::vector<const Config*> running;
+    std::vector<FILE*> pipes;
+    for (size_t i = 0; i < sizeof(configs) / sizeof(Config); i++) {
+        if (update && strcmp(configs[i].name, configs[i].golden)) continue;
+        std::string command = std::string("\"") + self + "\" golden --run " +
+            configs[i].name + (update ? " 1 " : " 0 ") + args;
+        if (FILE *pipe = popen(command.c_str(), "r")) {
+            running.push_back(&configs[i]);
+            pipes.push_back(pipe);
+        }
+        else {
+            printf("Failed to start %s\n", command.c_str());
+            return 1;
+        }
+    }
+
+    // Collect the results of each configuration as it finishes
+    int failures = 0;
+    for (size_t i = 0; i < pipes.size(); i++) {
+        int checked = 0, passed = 0;
+        std::string details;
+        char line[256];
+        while (fgets(line, sizeof(line), pipes[i])) {
+            int frame, offset = 0;
+            unsigned long long video;
+            unsigned int audio;
+            char status[16];
+            if (sscanf(line, "golden %d %llx %x %15s", &frame, &video, &audio, status) == 4) {
+                checked++;
+                if (!strcmp(status, "ok") || !strcmp(status, "new")) {
+                    passed++;
+                    continue;
+                }
+                snprintf(line, sizeof(line), "    frame %d: %s mismatch\n", frame, status);
+                details += line;
+            }
+            else if (sscanf(line, "desync %d %n", &frame, &offset) == 1) {
+                details += "    movie desynced at frame " + std::to_string(frame) + ": " + &line[offset];
+            }
+            else if (!strncmp(line, "error ", 6)) {
+                details += std::string("    ") + &line[6];
+            }
+        }
+
+        // Count configurations that failed to run, as well as those with mismatches
+        bool failed = (pclose(pipes[i]) != 0);
+        failures += failed;
+        printf("  %-18s %s %d/%d frames\n%s", running[i]->name, update ? "updated" :
+            (failed ? "FAILED" : "passed"), passed, checked, details.c_str());
+    }
+    return failures;
+}
+
+int runGolden(const char *self, int argc, char **argv) {
+    if (argc >= 6 && !strcmp(argv[0], "--run")) {
+        // Run a single configuration, as a child of the main harness process
+        for (size_t i = 0; i < sizeof(configs) / sizeof(Config); i++) {
+            if (strcmp(configs[i].name, argv[1])) continue;
+            std::vector<int> frames;
+            for (int j = 5; j < argc; j++)
+                frames.push_back(atoi(argv[j]));
+            std::sort(frames.begin(), frames.end());
+            return runConfig(configs[i], atoi(argv[2]), argv[3], argv[4], frames);
+        }
+        printf("error Unknown configuration %s\n", argv[1]);
+        return 1;
+    }
+
+    if (argc < 1) {
+        printf("Usage: noods-bench golden <manifest> [update]\n");
+        return 1;
+    }
+
+    // Read the manifest, where each line has a ROM, a movie or "-", and the frame numbers to check
+    FILE *file = fopen(argv[0], "r");
+    if (!file) {
+        printf("Failed to open %s\n", argv[0]);
+        return 1;
+    }
+    bool update = (argc > 1 && !strcmp(argv[1], "update"));
+    int tests = 0, failures = 0;
+    char line[1024];
+
+    while (fgets(line, sizeof(line), file)) {
+        std::istringstream stream(line);
+        std::string rom, movie, args, frame;
+        if (!(stream >> rom >> movie) || rom[0] == '#') continue;
+        while (stream >> frame)
+            args += " " + frame;
+        if (args == "") continue;
+
+        // Update the golden data first if requested, then check every configuration against it
+        printf("%s\n", rom.c_str());
+        fflush(stdout);
+        args = "\"" + rom + "\" \"" + movie + "\"" + args;
+        tests++;
+        if (update && runTest(self, true, args)) {
+            failures++;
+            continue;
+        }
+        failures += (runTest(self, false, args) != 0);
+    }
+
+    fclose(file);
+    printf("%d of %d tests passed\n", tests - failures, tests);
+    return failures ? 1 : 0;
+}
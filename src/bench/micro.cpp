@@ -0,0 +1,397 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "bench.h"
+#include "../core.h"
+
+// Where the interpreter loops store their iteration counts, and where test data goes
+#define COUNTER 0x2200000
+#define DATA 0x2100000
+
+// Path of the generated ROM that each kernel's core boots
+#define ROM_PATH "micro.nds"
+
+struct Kernel {
+    const char *name;
+    const char *unit;
+    double (*run)(); // Returns nanoseconds per unit
+};
+
+// ARM code that halts the CPU forever, for when only the setup of a core matters
+static const uint32_t haltCode[] = {
+    0xE3A00080, // mov r0,#0x80
+    0xE59F1004, // ldr r1,=HALTCNT
+    0xE5C10000, // strb r0,[r1]
+    0xEAFFFFFE, // b .
+    0x4000301
+};
+
+// ARM9 loop of ALU operations in ARM mode, with 16 instructions per iteration
+static const uint32_t armAluCode[] = {
+    0xE3A01622, // mov r1,#COUNTER
+    0xE3A00000, // mov r0,#0
+    0xE2800001, // loop: add r0,r0,#1
+    0xE0822000, // add r2,r2,r0
+    0xE0423100, // sub r3,r2,r0,lsl #2
+    0xE0234002, // eor r4,r3,r2
+    0xE18451A0, // orr r5,r4,r0,lsr #3
+    0xE0056003, // and r6,r5,r3
+    0xE1A072E6, // mov r7,r6,ror #5
+    0xE2678C01, // rsb r8,r7,#0x100
+    0xE0989002, // adds r9,r8,r2
+    0xE0A9A004, // adc r10,r9,r4
+    0xE3CAB0F0, // bic r11,r10,#0xF0
+    0xE15B0005, // cmp r11,r5
+    0x11A0C00B, // movne r12,r11
+    0xE0020695, // mul r2,r5,r6
+    0xE5810000, // str r0,[r1]
+    0xEAFFFFEF // b loop
+};
+
+// ARM9 loop of loads and stores in ARM mode, with 15 instructions per iteration
+static const uint32_t armMemCode[] = {
+    0xE3A01622, // mov r1,#COUNTER
+    0xE3A02621, // mov r2,#DATA
+    0xE3A00000, // mov r0,#0
+    0xE2800001, // loop: add r0,r0,#1
+    0xE5820000, // str r0,[r2]
+    0xE5923000, // ldr r3,[r2]
+    0xE1C230B4, // strh r3,[r2,#4]
+    0xE1D240B4, // ldrh r4,[r2,#4]
+    0xE5C24008, // strb r4,[r2,#8]
+    0xE1D250D8, // ldrsb r5,[r2,#8]
+    0xE20080FF, // and r8,r0,#0xFF
+    0xE7926108, // ldr r6,[r2,r8,lsl #2]
+    0xE5A2600C, // str r6,[r2,#12]!
+    0xE412700C, // ldr r7,[r2],#-12
+    0xE8820078, // stmia r2,{r3-r6}
+    0xE8920078, // ldmia r2,{r3-r6}
+    0xE5810000, // str r0,[r1]
+    0xEAFFFFF0 // b loop
+};
+
+// ARM9 loop of ALU operations in THUMB mode, with 15 instructions per iteration
+static const uint16_t thumbAluCode[] = {
+    0x0001, 0xE28F, // add r0,pc,#1
+    0xFF10, 0xE12F, // bx r0
+    0x4908, // ldr r1,=COUNTER
+    0x2000, // mov r0,#0
+    0x3001, // loop: add r0,#1
+    0x1812, // add r2,r2,r0
+    0x0093, // lsl r3,r2,#2
+    0x1A1B, // sub r3,r3,r0
+    0x405C, // eor r4,r3
+    0x4314, // orr r4,r2
+    0x401C, // and r4,r3
+    0x08E5, // lsr r5,r4,#3
+    0x43EE, // mvn r6,r5
+    0x4166, // adc r6,r4
+    0x4386, // bic r6,r0
+    0x4372, // mul r2,r6
+    0x42AE, // cmp r6,r5
+    0x6008, // str r0,[r1]
+    0xE7F0, // b loop
+    0x0000,
+    COUNTER & 0xFFFF, COUNTER >> 16
+};
+
+// ARM9 loop of loads and stores in THUMB mode, with 15 instructions per iteration
+static const uint16_t thumbMemCode[] = {
+    0x0001, 0xE28F, // add r0,pc,#1
+    0xFF10, 0xE12F, // bx r0
+    0x4908, // ldr r1,=COUNTER
+    0x4A09, // ldr r2,=DATA
+    0x2000, // mov r0,#0
+    0x3001, // loop: add r0,#1
+    0x6010, // str r0,[r2]
+    0x6813, // ldr r3,[r2]
+    0x8093, // strh r3,[r2,#4]
+    0x8894, // ldrh r4,[r2,#4]
+    0x7214, // strb r4,[r2,#8]
+    0x7A15, // ldrb r5,[r2,#8]
+    0xB438, // push {r3-r5}
+    0xBC38, // pop {r3-r5}
+    0xC238, // stmia r2!,{r3-r5}
+    0x3A0C, // sub r2,#12
+    0xCA38, // ldmia r2!,{r3-r5}
+    0x3A0C, // sub r2,#12
+    0x6008, // str r0,[r1]
+    0xE7F0, // b loop
+    COUNTER & 0xFFFF, COUNTER >> 16,
+    DATA & 0xFFFF, DATA >> 16
+};
+
+static uint32_t nextRandom(uint32_t &seed) {
+    // Generate pseudo-random numbers that are the same on every run
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static void fill(Core *core, bool arm7, uint32_t address, uint32_t size, uint32_t seed) {
+    // Fill memory with pseudo-random data through the CPU's view of it
+    for (uint32_t i = 0; i < size; i += 4)
+        core->memory.write<uint32_t>(arm7, address + i, nextRandom(seed));
+}
+
+static Core *createCore(const void *code9, size_t size9) {
+    // Boot a generated ROM, with the ARM7 halted so it doesn't take any time
+    writeRom(ROM_PATH, code9, size9, haltCode, sizeof(haltCode));
+    return new Core(ROM_PATH);
+}
+
+template <typename F> static double measure(F func) {
+    // Time a function in nanoseconds
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double runInterpreter(const void *code, size_t size, int instrs) {
+    // Warm up for a few frames, and then count loop iterations over 2 seconds of emulation
+    Core *core = createCore(code, size);
+    for (int i = 0; i < 10; i++)
+        core->runCore();
+    uint32_t start = core->memory.read<uint32_t>(0, COUNTER);
+    double time = measure([&] { for (int i = 0; i < 120; i++) core->runCore(); });
+    double count = double(core->memory.read<uint32_t>(0, COUNTER) - start) * instrs;
+    delete core;
+    return time / count;
+}
+
+static double runGpu2D(int mode) {
+    // Map VRAM for engine A's backgrounds and objects, and fill it with noise
+    Core *core = createCore(haltCode, sizeof(haltCode));
+    core->memory.write<uint16_t>(0, 0x4000304, 0x820F); // POWCNT1
+    core->memory.write<uint8_t>(0, 0x4000240, 0x81); // VRAMCNT_A
+    core->memory.write<uint8_t>(0, 0x4000241, 0x82); // VRAMCNT_B
+    fill(core, 0, 0x6000000, 0x20000, 1);
+    fill(core, 0, 0x6400000, 0x20000, 2);
+    fill(core, 0, 0x5000000, 0x400, 3);
+
+    // Place 128 32x32 sprites at pseudo-random positions, alternating between 16 and 256 colors
+    uint32_t seed = 4;
+    for (int i = 0; i < 128; i++) {
+        core->memory.write<uint16_t>(0, 0x7000000 + i * 8, (nextRandom(seed) % 192) | ((i & 1) << 13));
+        core->memory.write<uint16_t>(0, 0x7000002 + i * 8, (nextRandom(seed) % 256) | (2 << 14));
+        core->memory.write<uint16_t>(0, 0x7000004 + i * 8, ((i * 16) & 0x3FF) | ((i & 3) << 10));
+    }
+
+    // Enable all backgrounds in the given mode, with extended ones as direct color bitmaps
+    // Affine and extended backgrounds are 256x256 with identity transforms
+    core->memory.write<uint32_t>(0, 0x4000000, 0x10F10 | mode); // DISPCNT
+    for (int i = 0; i < 4; i++) {
+        bool extended = (i == 3 && mode >= 3) || (i == 2 && mode == 5);
+        core->memory.write<uint16_t>(0, 0x4000008 + i * 2, extended ? (0x4084 | (i << 8)) : (0x4000 | i | (i << 2) | ((8 + i) << 8)));
+    }
+    for (int i = 0; i < 2; i++) {
+        core->memory.write<uint16_t>(0, 0x4000020 + i * 0x10, 0x100); // BGxPA
+        core->memory.write<uint16_t>(0, 0x4000026 + i * 0x10, 0x100); // BGxPD
+    }
+
+    // Draw 60 frames worth of scanlines
+    double time = measure([&] {
+        for (int i = 0; i < 60 * 192; i++)
+            core->gpu2D[0].drawScanline(i % 192);
+    });
+    delete core;
+    return time / (60 * 192);
+}
+
+static double runGpu3D(int count, int size) {
+    // Generate a soup of triangles at pseudo-random positions and depths, with Gouraud shading
+    Core *core = createCore(haltCode, sizeof(haltCode));
+    Gpu3D &gpu3D = core->gpu3D;
+    core->gpu3DRenderer.writeClearDepth(0xFFFF, 0x7FFF);
+    uint32_t seed = 5;
+    for (int i = 0; i < count; i++) {
+        _Polygon &polygon = gpu3D.polygonsOut[i];
+        polygon = _Polygon();
+        polygon.vertices = i * 3;
+        polygon.size = 3;
+        polygon.alpha = 31;
+        polygon.id = i & 0x3F;
+
+        int x = nextRandom(seed) % (256 - size);
+        int y = nextRandom(seed) % (192 - size);
+        int xs[] = { x, x + size, x };
+        int ys[] = { y, y + size / 2, y + size };
+        for (int j = 0; j < 3; j++) {
+            Vertex &vertex = gpu3D.verticesOut[i * 3 + j];
+            vertex = Vertex();
+            vertex.x = xs[j];
+            vertex.y = ys[j];
+            vertex.z = nextRandom(seed) & 0x7FFFFF;
+            vertex.w = 0x1000;
+            vertex.color = nextRandom(seed) & 0x3FFFF;
+        }
+    }
+    gpu3D.polygonCountOut = count;
+    gpu3D.vertexCountOut = count * 3;
+
+    // Render 60 frames of the same scene
+    double time = measure([&] {
+        for (int i = 0; i < 60 * 192; i++)
+            core->gpu3DRenderer.drawScanline(i % 192);
+    });
+    delete core;
+    return time / (60 * count);
+}
+
+static double runSpu() {
+    // Fill the sample data and enable sound output at full volume
+    Core *core = createCore(haltCode, sizeof(haltCode));
+    fill(core, 1, DATA, 0x10000, 6);
+    core->memory.write<uint16_t>(1, 0x4000304, 0x0001); // POWCNT2
+    core->memory.write<uint16_t>(1, 0x4000500, 0x807F); // SOUNDCNT
+
+    // Start all 16 channels looping at different rates, using every format a channel supports
+    // Channels 0-7 play PCM16, 8-11 play ADPCM, 12-13 play pulse waves, and 14-15 play noise
+    for (int i = 0; i < 16; i++) {
+        uint32_t base = 0x4000400 + i * 0x10;
+        uint32_t format = (i < 8) ? 1 : (i < 12) ? 2 : 3;
+        core->memory.write<uint32_t>(1, base + 0x4, DATA + i * 0x1000); // SOUNDxSAD
+        core->memory.write<uint16_t>(1, base + 0x8, 0x10000 - (0x200 + i * 0x20)); // SOUNDxTMR
+        core->memory.write<uint16_t>(1, base + 0xA, 0); // SOUNDxPNT
+        core->memory.write<uint32_t>(1, base + 0xC, 0x400); // SOUNDxLEN
+        core->memory.write<uint32_t>(1, base, BIT(31) | (format << 29) | BIT(27) | ((i & 7) << 24) | ((i * 8) << 16) | 0x7F);
+    }
+
+    // Mix 10 seconds of samples, dropping the tasks each one schedules so the queue doesn't grow
+    int samples = 32768 * 10;
+    double time = measure([&] {
+        for (int i = 0; i < samples; i++) {
+            core->spu.runSample();
+            if ((i & 0xFF) == 0xFF) {
+                core->events.erase(std::remove_if(core->events.begin(), core->events.end(),
+                    [](SchedEvent &event) { return event.task == NDS_SPU_SAMPLE; }), core->events.end());
+            }
+        }
+    });
+    delete core;
+    return time / samples;
+}
+
+static double runMemory(int mix) {
+    // Map VRAM to LCDC so it can be accessed in the mixed workload
+    Core *core = createCore(haltCode, sizeof(haltCode));
+    core->memory.write<uint8_t>(0, 0x4000240, 0x80); // VRAMCNT_A
+
+    // Generate a list of accesses, each with an address, a width, and a direction
+    // Mix 0 is main RAM words, mix 1 is all widths across memory areas, and mix 2 is polled I/O registers
+    static const uint32_t areas[] = { 0x2000000, 0x3000000, 0x5000000, 0x6800000, 0x7000000 };
+    static const uint32_t registers[] = { 0x4000004, 0x4000006, 0x4000100, 0x4000130, 0x4000180, 0x4000210, 0x4000214 };
+    uint32_t addresses[4096];
+    uint8_t ops[4096];
+    uint32_t seed = 7;
+    for (int i = 0; i < 4096; i++) {
+        uint32_t value = nextRandom(seed);
+        switch (mix) {
+        case 0:
+            addresses[i] = DATA + ((value & 0xFFFF) << 2);
+            ops[i] = 4 | ((value >> 20) & 0x8);
+            break;
+
+        case 1:
+            ops[i] = (1 << (value % 3)) | ((value >> 20) & 0x8);
+            addresses[i] = (areas[(value >> 4) % 5] + ((value >> 8) & 0x3FF)) & ~((ops[i] & 0x7) - 1);
+            break;
+
+        case 2:
+            addresses[i] = registers[value % 7];
+            ops[i] = 2;
+            break;
+        }
+    }
+
+    // Run through the list of accesses 256 times, with bit 3 of an op marking a write
+    uint32_t sum = 0;
+    double time = measure([&] {
+        for (int j = 0; j < 256; j++) {
+            for (int i = 0; i < 4096; i++) {
+                switch (ops[i]) {
+                    case 1: sum += core->memory.read<uint8_t>(0, addresses[i]); break;
+                    case 2: sum += core->memory.read<uint16_t>(0, addresses[i]); break;
+                    case 4: sum += core->memory.read<uint32_t>(0, addresses[i]); break;
+                    case 9: core->memory.write<uint8_t>(0, addresses[i], sum); break;
+                    case 10: core->memory.write<uint16_t>(0, addresses[i], sum); break;
+                    case 12: core->memory.write<uint32_t>(0, addresses[i], sum); break;
+                }
+            }
+        }
+    });
+    delete core;
+    return time / (256 * 4096);
+}
+
+static double armAlu() { return runInterpreter(armAluCode, sizeof(armAluCode), 16); }
+static double armMem() { return runInterpreter(armMemCode, sizeof(armMemCode), 15); }
+static double thumbAlu() { return runInterpreter(thumbAluCode, sizeof(thumbAluCode), 15); }
+static double thumbMem() { return runInterpreter(thumbMemCode, sizeof(thumbMemCode), 15); }
+static double gpu2DMode0() { return runGpu2D(0); }
+static double gpu2DMode1() { return runGpu2D(1); }
+static double gpu2DMode2() { return runGpu2D(2); }
+static double gpu2DMode3() { return runGpu2D(3); }
+static double gpu2DMode4() { return runGpu2D(4); }
+static double gpu2DMode5() { return runGpu2D(5); }
+static double gpu3DSmall() { return runGpu3D(2048, 8); }
+static double gpu3DLarge() { return runGpu3D(256, 64); }
+static double memoryRam() { return runMemory(0); }
+static double memoryMixed() { return runMemory(1); }
+static double memoryIo() { return runMemory(2); }
+
+static const Kernel kernels[] = {
+    { "arm-alu", "instruction", armAlu },
+    { "arm-mem", "instruction", armMem },
+    { "thumb-alu", "instruction", thumbAlu },
+    { "thumb-mem", "instruction", thumbMem },
+    { "gpu2d-mode0", "scanline", gpu2DMode0 },
+    { "gpu2d-mode1", "scanline", gpu2DMode1 },
+    { "gpu2d-mode2", "scanline", gpu2DMode2 },
+    { "gpu2d-mode3", "scanline", gpu2DMode3 },
+    { "gpu2d-mode4", "scanline", gpu2DMode4 },
+    { "gpu2d-mode5", "scanline", gpu2DMode5 },
+    { "gpu3d-small", "polygon", gpu3DSmall },
+    { "gpu3d-large", "polygon", gpu3DLarge },
+    { "spu-16ch", "sample", runSpu },
+    { "memory-ram", "access", memoryRam },
+    { "memory-mixed", "access", memoryMixed },
+    { "memory-io", "access", memoryIo }
+};
+
+int runMicro(int argc, char **argv) {
+    // Run the kernels with names containing the given filter, or all of them if there isn't one
+    const char *filter = (argc > 0) ? argv[0] : "";
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(Kernel); i++) {
+        if (!strstr(kernels[i].name, filter)) continue;
+        try {
+            printf("%-14s %10.2f ns/%s\n", kernels[i].name, kernels[i].run(), kernels[i].unit);
+            fflush(stdout);
+        }
+        catch (CoreError e) {
+            printf("Failed to boot %s\n", ROM_PATH);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "bench.h"
+#include "../core.h"
+
+// CPU quantums to compare, starting with exact interleaving as the reference
+static const int quantums[] = { 0, 1, 64, 256, 1024 };
+
+// ARM9 loop that reads a counter from the ARM7 and mixes it into a running value
+// The result depends on exactly how the CPUs are interleaved, so it shows when a quantum changes it
+static const uint32_t arm9Code[] = {
+    0xE3A01621, // mov r1,#0x2100000
+    0xE59F5014, // ldr r5,=0x2100004
+    0xE3A02000, // mov r2,#0
+    0xE5910000, // loop: ldr r0,[r1]
+    0xE0822000, // add r2,r2,r0
+    0xE0222182, // eor r2,r2,r2,lsl #3
+    0xE5852000, // str r2,[r5]
+    0xEAFFFFFA, // b loop
+    0x02100004
+};
+
+// ARM7 loop that counts up in shared main RAM
+static const uint32_t arm7Code[] = {
+    0xE3A01621, // mov r1,#0x2100000
+    0xE3A00000, // mov r0,#0
+    0xE2800001, // loop: add r0,r0,#1
+    0xE5810000, // str r0,[r1]
+    0xEAFFFFFC // b loop
+};
+
+int runQuantum(int argc, char **argv) {
+    // Parse the frame count, ROM, and optional movie that provides the same input to every run
+    // A ROM where the CPUs share memory is generated if none is given
+    int frames = (argc > 0) ? atoi(argv[0]) : 600;
+    std::string rom = (argc > 1) ? argv[1] : "quantum.nds";
+    std::string movie = (argc > 2) ? argv[2] : "";
+    if (argc <= 1)
+        writeRom(rom.c_str(), arm9Code, sizeof(arm9Code), arm7Code, sizeof(arm7Code));
+    uint64_t baseRam = 0, baseVideo = 0;
+    double baseFps = 0;
+    int result = 0;
+
+    for (size_t i = 0; i < sizeof(quantums) / sizeof(int); i++) {
+        // Run the ROM from boot with the quantum, keeping threading out of it so only interleaving differs
+        Settings::cpuQuantum = quantums[i];
+        Settings::arm7Thread = 0;
+        Settings::adaptiveRes3D = 0;
+        Settings::adaptiveSkip = 0;
+        Core *core;
+        try {
+            core = new Core(rom);
+        }
+        catch (CoreError e) {
+            printf("Failed to load %s\n", rom.c_str());
+            return 1;
+        }
+
+        // Replay the movie from boot if given, so every run sees the same input
+        if (movie != "" && !core->movie.startPlayback(movie)) {
+            printf("Failed to open movie %s\n", movie.c_str());
+            delete core;
+            return 1;
+        }
+
+        // Time the frames, draining each one so the last is complete when it's hashed
+        std::vector<uint32_t> pixels(256 * 384);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int j = 0; j < frames; j++) {
+            core->runCore();
+            core->gpu.getFrame(pixels.data(), false);
+        }
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+        // Hash guest RAM and the last frame to see if the quantum changed anything the guest did
+        uint64_t ram = core->memory.hashRam();
+        uint64_t video = 0xCBF29CE484222325;
+        for (size_t j = 0; j < pixels.size(); j++)
+            video = (video ^ pixels[j]) * 0x100000001B3;
+        double fps = frames / time.count();
+        delete core;
+
+        if (!quantums[i]) {
+            baseRam = ram;
+            baseVideo = video;
+            baseFps = fps;
+            printf("Quantum 0: %.1f FPS (reference)\n", fps);
+            continue;
+        }
+
+        // A quantum of 1 is equivalent to exact interleaving, so it fails the run if it doesn't match
+        bool match = (ram == baseRam && video == baseVideo);
+        printf("Quantum %d: %.1f FPS (%+.1f%%), output %s\n", quantums[i], fps,
+            (fps / baseFps - 1) * 100, match ? "matches" : "differs");
+        if (!match && quantums[i] == 1)
+            result = 1;
+    }
+    return result;
+}
@@ -0,0 +1,394 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <map>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "../core.h"
+
+#ifdef WINDOWS
+#include <io.h>
+#endif
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+// The number of scheduler tasks and unknown I/O registers reported for each ROM
+#define TOP_TASKS 5
+#define TOP_IO 10
+
+struct SweepResult {
+    std::string rom;
+    std::string status = "crash";
+    int frames = 0;
+    double fps = 0;
+    std::vector<std::pair<std::string, double>> tasks; // Name and count per frame
+    std::vector<std::string> unknownIo; // CPU, direction, address, and count
+};
+
+// Names of the scheduler tasks, in the same order as the SchedTask enum
+static const char *taskNames[] = {
+    "UPDATE_RUN", "RESET_CYCLES", "CART9_WORD_READY", "CART7_WORD_READY",
+    "DMA9_TRANSFER0", "DMA9_TRANSFER1", "DMA9_TRANSFER2", "DMA9_TRANSFER3",
+    "DMA7_TRANSFER0", "DMA7_TRANSFER1", "DMA7_TRANSFER2", "DMA7_TRANSFER3",
+    "NDS_SCANLINE256", "NDS_SCANLINE355", "GBA_SCANLINE240", "GBA_SCANLINE308",
+    "GPU3D_COMMANDS", "ARM9_INTERRUPT", "ARM7_INTERRUPT", "NDS_SPU_SAMPLE", "GBA_SPU_SAMPLE",
+    "TIMER9_OVERFLOW0", "TIMER9_OVERFLOW1", "TIMER9_OVERFLOW2", "TIMER9_OVERFLOW3",
+    "TIMER7_OVERFLOW0", "TIMER7_OVERFLOW1", "TIMER7_OVERFLOW2", "TIMER7_OVERFLOW3",
+    "WIFI_COUNT_MS", "WIFI_TRANS_REPLY", "WIFI_TRANS_ACK", "PROFILER_SAMPLE"
+};
+static_assert(sizeof(taskNames) / sizeof(taskNames[0]) == MAX_TASKS, "Task names don't match SchedTask");
+
+static int runRom(const char *rom, int frames, int timeout, const char *scratch) {
+    // Start a watchdog that reports a hang and exits if the ROM runs for too long
+    // Exiting outright is the only way out if emulation is stuck, and it skips saving anything
+    std::atomic<int> frame(0);
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool finished = false;
+    std::thread watchdog([&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (cond.wait_for(lock, std::chrono::seconds(timeout), [&] { return finished; })) return;
+        printf("status hang %d\n", frame.load());
+        fflush(stdout);
+        std::_Exit(2);
+    });
+
+    // Keep saves in the run's scratch folder, so the save type is auto-detected like on a fresh boot
+    // This keeps the sweep from reading or writing saves in the directory it surveys
+    Settings::basePath = scratch;
+    Settings::savesFolder = 1;
+    mkdir((Settings::basePath + "/saves").c_str() MKDIR_ARGS);
+
+    // Load the ROM into the NDS or GBA slot depending on its extension
+    std::string path = rom;
+    std::string ext = path.substr(path.rfind('.'));
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    bool gba = (ext == ".gba");
+    Core *core;
+    try {
+        core = new Core(gba ? "" : path, gba ? path : "");
+    }
+    catch (CoreError e) {
+        printf("status error 0\n");
+        { std::lock_guard<std::mutex> guard(mutex); finished = true; }
+        cond.notify_one();
+        watchdog.join();
+        return 1;
+    }
+
+    // Count accesses to unknown I/O registers, which the core skips unless asked
+    core->profiler.trackUnknownIo(true);
+
+    // Count how often each scheduler task runs by wrapping the bound functions
+    uint64_t counts[MAX_TASKS] = {};
+    for (int i = 0; i < MAX_TASKS; i++) {
+        std::function<void()> task = core->tasks[i];
+        if (task) core->tasks[i] = [task, &counts, i] { counts[i]++; task(); };
+    }
+
+    // Run the requested number of frames as fast as possible
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (; frame < frames; frame++)
+        core->runCore();
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+    { // Stop the watchdog now that the ROM finished in time
+        std::lock_guard<std::mutex> guard(mutex);
+        finished = true;
+    }
+    cond.notify_one();
+    watchdog.join();
+    printf("fps %.1f\n", frames / time.count());
+
+    // Report the most frequent scheduler tasks
+    std::vector<std::pair<uint64_t, int>> tasks;
+    for (int i = 0; i < MAX_TASKS; i++)
+        if (counts[i]) tasks.push_back(std::make_pair(counts[i], i));
+    std::sort(tasks.rbegin(), tasks.rend());
+    for (size_t i = 0; i < tasks.size() && i < TOP_TASKS; i++)
+        printf("task %s %.1f\n", taskNames[tasks[i].second], double(tasks[i].first) / frames);
+
+    // Report the most accessed unknown I/O registers
+    std::vector<std::pair<uint32_t, uint64_t>> unknown;
+    for (int i = 0; i < 2; i++) {
+        const std::unordered_map<uint64_t, uint32_t> &io = core->profiler.getUnknownIo(i);
+        for (auto it = io.begin(); it != io.end(); it++)
+            unknown.push_back(std::make_pair(it->second, it->first | (uint64_t(i) << 40)));
+    }
+    std::sort(unknown.rbegin(), unknown.rend());
+    for (size_t i = 0; i < unknown.size() && i < TOP_IO; i++) {
+        uint64_t key = unknown[i].second;
+        printf("io %s %s 0x%08X %u\n", core->gbaMode ? "GBA" : ((key >> 40) ? "ARM7" : "ARM9"),
+            (key & 0x1) ? "W" : "R", uint32_t(key >> 1), unknown[i].first);
+    }
+
+    printf("status ok %d\n", frames);
+    delete core;
+    return 0;
+}
+
+static SweepResult runChild(const char *self, std::string rom, int frames, int timeout, std::string scratch) {
+    // Run a ROM in a separate process, so crashes and hangs don't take down the sweep
+    SweepResult result;
+    result.rom = rom;
+    mkdir(scratch.c_str() MKDIR_ARGS);
+    std::string command = std::string("\"") + self + "\" sweep --run \"" + rom + "\" " +
+        std::to_string(frames) + " " + std::to_string(timeout) + " \"" + scratch + "\"";
+    FILE *pipe = popen(command.c_str(), "r");
+    if (!pipe) return result;
+
+    // Parse the results, leaving the status as a crash if the process ends without one
+    char line[512], name[64], cpu[8], dir[4];
+    unsigned int address, count;
+    double value;
+    while (fgets(line, sizeof(line), pipe)) {
+        if (sscanf(line, "status %63s %d", name, &result.frames) == 2)
+            result.status = name;
+        else if (sscanf(line, "fps %lf", &value) == 1)
+            result.fps = value;
+        else if (sscanf(line, "task %63s %lf", name, &value) == 2)
+            result.tasks.push_back(std::make_pair(std::string(name), value));
+        else if (sscanf(line, "io %7s %3s %x %u", cpu, dir, &address, &count) == 4) {
+            snprintf(line, sizeof(line), "%s %s 0x%08X x%u", cpu, dir, address, count);
+            result.unknownIo.push_back(line);
+        }
+    }
+    pclose(pipe);
+    return result;
+}
+
+static std::vector<std::string> findRoms(std::string path) {
+    // Get the NDS and GBA ROMs in a directory, in a stable order
+    std::vector<std::string> roms;
+    if (DIR *dir = opendir(path.c_str())) {
+        while (dirent *entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            size_t dot = name.rfind('.');
+            if (dot == std::string::npos) continue;
+            std::string ext = name.substr(dot);
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".nds" || ext == ".gba")
+                roms.push_back(path + "/" + name);
+        }
+        closedir(dir);
+    }
+    std::sort(roms.begin(), roms.end());
+    return roms;
+}
+
+static std::string makeScratch() {
+    // Make a uniquely named scratch folder in the current directory for the runs' saves
+    char path[] = "noods-sweep-XXXXXX";
+#ifdef WINDOWS
+    if (_mktemp(path) && !mkdir(path MKDIR_ARGS)) return path;
+#else
+    if (mkdtemp(path)) return path;
+#endif
+    return "";
+}
+
+static void removeScratch(std::string path) {
+    // Delete a scratch folder along with everything the runs left in it
+    if (DIR *dir = opendir(path.c_str())) {
+        while (dirent *entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            std::string child = path + "/" + name;
+            if (remove(child.c_str()))
+                removeScratch(child);
+        }
+        closedir(dir);
+    }
+    rmdir(path.c_str());
+}
+
+static std::string escape(std::string text, char quote) {
+    // Escape a string for CSV, where quotes are doubled, or JSON, where quotes and backslashes get a backslash
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '"') out += (quote == ',') ? "\"\"" : "\\\"";
+        else if (text[i] == '\\' && quote != ',') out += "\\\\";
+        else out += text[i];
+    }
+    return out;
+}
+
+static void writeReports(std::vector<SweepResult> &results) {
+    // Write a CSV report, with lists in a field separated by semicolons
+    if (FILE *file = fopen("sweep.csv", "w")) {
+        fprintf(file, "rom,status,frames,fps,tasks,unknown_io\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            std::string tasks, io;
+            for (size_t j = 0; j < results[i].tasks.size(); j++) {
+                char task[96];
+                snprintf(task, sizeof(task), "%s%s:%.1f", j ? ";" : "", results[i].tasks[j].first.c_str(), results[i].tasks[j].second);
+                tasks += task;
+            }
+            for (size_t j = 0; j < results[i].unknownIo.size(); j++)
+                io += (j ? ";" : "") + results[i].unknownIo[j];
+            fprintf(file, "\"%s\",%s,%d,%.1f,\"%s\",\"%s\"\n", escape(results[i].rom, ',').c_str(),
+                results[i].status.c_str(), results[i].frames, results[i].fps, tasks.c_str(), io.c_str());
+        }
+        fclose(file);
+    }
+
+    // Write the same data as JSON
+    if (FILE *file = fopen("sweep.json", "w")) {
+        fprintf(file, "[\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            fprintf(file, "  { \"rom\": \"%s\", \"status\": \"%s\", \"frames\": %d, \"fps\": %.1f,\n    \"tasks\": [",
+                escape(results[i].rom, '"').c_str(), results[i].status.c_str(), results[i].frames, results[i].fps);
+            for (size_t j = 0; j < results[i].tasks.size(); j++)
+                fprintf(file, "%s{ \"name\": \"%s\", \"perFrame\": %.1f }", j ? ", " : "",
+                    results[i].tasks[j].first.c_str(), results[i].tasks[j].second);
+            fprintf(file, "],\n    \"unknownIo\": [");
+            for (size_t j = 0; j < results[i].unknownIo.size(); j++)
+                fprintf(file, "%s\"%s\"", j ? ", " : "", results[i].unknownIo[j].c_str());
+            fprintf(file, "] }%s\n", (i + 1 < results.size()) ? "," : "");
+        }
+        fprintf(file, "]\n");
+        fclose(file);
+    }
+}
+
+static void compareReport(std::string path, std::vector<SweepResult> &results) {
+    // Read the ROM, status, and FPS from each line of a previous CSV report
+    FILE *file = fopen(path.c_str(), "r");
+    if (!file) {
+        printf("Failed to open %s\n", path.c_str());
+        return;
+    }
+    std::map<std::string, std::pair<std::string, double>> previous;
+    char line[4096];
+    fgets(line, sizeof(line), file);
+    while (fgets(line, sizeof(line), file)) {
+        // The ROM is quoted, with quotes inside it doubled
+        std::string rom;
+        char *c = line + 1;
+        for (; *c && !(c[0] == '"' && c[1] != '"'); c++) {
+            if (c[0] == '"') c++;
+            rom += *c;
+        }
+        char status[64];
+        int frames;
+        double fps;
+        if (*c && sscanf(c, "\",%63[^,],%d,%lf", status, &frames, &fps) == 3)
+            previous[rom] = std::make_pair(std::string(status), fps);
+    }
+    fclose(file);
+
+    // Report status changes, and speed changes of at least 10%
+    printf("Changes since %s:\n", path.c_str());
+    int changes = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        SweepResult &result = results[i];
+        auto it = previous.find(result.rom);
+        if (it == previous.end()) {
+            printf("  %s: new, %s\n", result.rom.c_str(), result.status.c_str());
+            changes++;
+        }
+        else if (it->second.first != result.status) {
+            printf("  %s: %s -> %s\n", result.rom.c_str(), it->second.first.c_str(), result.status.c_str());
+            changes++;
+        }
+        else if (it->second.second > 0 && std::abs(result.fps / it->second.second - 1) >= 0.1) {
+            printf("  %s: %.1f -> %.1f FPS (%+.0f%%)\n", result.rom.c_str(), it->second.second,
+                result.fps, (result.fps / it->second.second - 1) * 100);
+            changes++;
+        }
+        if (it != previous.end())
+            previous.erase(it);
+    }
+    for (auto it = previous.begin(); it != previous.end(); it++, changes++)
+        printf("  %s: removed\n", it->first.c_str());
+    if (!changes)
+        printf("  None\n");
+}
+
+int runSweep(const char *self, int argc, char **argv) {
+    // Run a single ROM, as a child of the main sweep process
+    if (argc >= 5 && !strcmp(argv[0], "--run"))
+        return runRom(argv[1], std::max(atoi(argv[2]), 1), std::max(atoi(argv[3]), 1), argv[4]);
+
+    if (argc < 1) {
+        printf("Usage: noods-bench sweep <rom directory> [frames] [timeout] [previous.csv]\n");
+        return 1;
+    }
+
+    // Find the ROMs to run, with defaults of 10 seconds of emulation and a minute to run it
+    std::vector<std::string> roms = findRoms(argv[0]);
+    int frames = (argc > 1) ? atoi(argv[1]) : 600;
+    int timeout = (argc > 2) ? atoi(argv[2]) : 60;
+    if (roms.empty()) {
+        printf("No ROMs found in %s\n", argv[0]);
+        return 1;
+    }
+
+    // Give each run its own scratch folder for saves, so ROMs with the same name don't share one
+    std::string scratch = makeScratch();
+    if (scratch == "") {
+        printf("Failed to create a scratch folder\n");
+        return 1;
+    }
+
+    // Run the ROMs in parallel, with a worker thread for each host core that starts child processes
+    std::vector<SweepResult> results(roms.size());
+    std::atomic<size_t> next(0);
+    std::mutex mutex;
+    int done = 0;
+    std::vector<std::thread> workers;
+    int jobs = std::max<int>(std::thread::hardware_concurrency(), 1);
+    for (int i = 0; i < jobs; i++) {
+        workers.push_back(std::thread([&] {
+            for (size_t j; (j = next++) < roms.size();) {
+                results[j] = runChild(self, roms[j], frames, timeout, scratch + "/" + std::to_string(j));
+                std::lock_guard<std::mutex> guard(mutex);
+                printf("[%d/%d] %s: %s, %.1f FPS\n", ++done, int(roms.size()),
+                    roms[j].c_str(), results[j].status.c_str(), results[j].fps);
+                fflush(stdout);
+            }
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    removeScratch(scratch);
+
+    // Write the reports, and compare with a previous one if given
+    writeReports(results);
+    printf("Wrote sweep.csv and sweep.json\n");
+    if (argc > 3)
+        compareReport(argv[3], results);
+    return 0;
+}
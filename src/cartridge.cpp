@@ -81,6 +81,7 @@ bool Cartridge::loadRom() {
 
 void Cartridge::loadRomSection(size_t offset, size_t size) {
     // Load a section of the current ROM file into memory
+    WaitTimer timer(core->frameStats, PHASE_IO);
     if (rom) delete[] rom;
     rom = new uint8_t[size];
     fseek(romFile, offset, SEEK_SET);
@@ -88,6 +89,20 @@ void Cartridge::loadRomSection(size_t offset, size_t size) {
     core->dldi.patchRom(rom, offset, size);
 }
 
+void Cartridge::readRom(uint32_t offset, uint32_t size, uint8_t *data) {
+    // Read data from the ROM whether it's in memory or not, filling anything out of bounds
+    memset(data, 0, size);
+    if (offset >= (uint32_t)romSize) return;
+    size = std::min<uint32_t>(size, romSize - offset);
+    if (romFile) {
+        fseek(romFile, offset, SEEK_SET);
+        fread(data, sizeof(uint8_t), size, romFile);
+    }
+    else if (rom) {
+        memcpy(data, &rom[offset], size);
+    }
+}
+
 void Cartridge::writeSave() {
     // Update the save file if the data changed
     mutex.lock();
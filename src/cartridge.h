@@ -49,6 +49,7 @@ public:
 
     int getRomSize() { return romSize; }
     int getSaveSize() { return saveSize; }
+    void readRom(uint32_t offset, uint32_t size, uint8_t *data);
 
 protected:
     Core *core;
@@ -78,6 +79,7 @@ public:
 
     void directBoot();
     void wordReady(bool cpu);
+    uint32_t getRomCode() { return romCode; }
 
     uint16_t readAuxSpiCnt(bool cpu) { return auxSpiCnt[cpu]; }
     uint8_t readAuxSpiData(bool cpu) { return auxSpiData[cpu]; }
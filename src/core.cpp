@@ -25,12 +25,12 @@
 
 Core::Core(std::string ndsRom, std::string gbaRom, int id, int ndsRomFd, int gbaRomFd,
     int ndsSaveFd, int gbaSaveFd, int ndsStateFd, int gbaStateFd, int ndsCheatFd):
-        id(id), actionReplay(this), cartridgeGba(this), cartridgeNds(this), cp15(this), divSqrt(this),
-        dldi(this), dma { Dma(this, 0), Dma(this, 1) }, gpu(this), gpu2D { Gpu2D(this, 0), Gpu2D(this, 1) },
+        id(id), actionReplay(this), arm7Thread(this), cartridgeGba(this), cartridgeNds(this), cp15(this), divSqrt(this),
+        dldi(this), dma { Dma(this, 0), Dma(this, 1) }, framePacer(this), frameStats(this), gpu(this), gpu2D { Gpu2D(this, 0), Gpu2D(this, 1) },
         gpu3D(this), gpu3DRenderer(this), hleArm7(this), hleBios { HleBios(this, 0, HleBios::swiTable9),
         HleBios(this, 1, HleBios::swiTable7), HleBios(this, 1, HleBios::swiTableGba) }, input(this),
-        interpreter { Interpreter(this, 0), Interpreter(this, 1) }, ipc(this), memory(this), rtc(this),
-        saveStates(this), spi(this), spu(this), timers { Timers(this, 0), Timers(this, 1) }, wifi(this) {
+        interpreter { Interpreter(this, 0), Interpreter(this, 1) }, ipc(this), memory(this), movie(this), profiler(this), rtc(this),
+        saveStates(this), spi(this), spu(this), timers { Timers(this, 0), Timers(this, 1) }, wifi(this), wifiRemote(this) {
     // Try to load BIOS and firmware; require DS files when not direct booting
     bool required = !Settings::directBoot || (ndsRom == "" && gbaRom == "" && ndsRomFd == -1 && gbaRomFd == -1);
     if (!memory.loadBios9() && required) throw ERROR_BIOS;
@@ -71,6 +71,7 @@ Core::Core(std::string ndsRom, std::string gbaRom, int id, int ndsRomFd, int gba
     tasks[WIFI_COUNT_MS] = std::bind(&Wifi::countMs, &wifi);
     tasks[WIFI_TRANS_REPLY] = std::bind(&Wifi::transmitPacket, &wifi, CMD_REPLY);
     tasks[WIFI_TRANS_ACK] = std::bind(&Wifi::transmitPacket, &wifi, CMD_ACK);
+    tasks[PROFILER_SAMPLE] = std::bind(&Profiler::sample, &profiler);
 
     // Schedule initial tasks for NDS mode
     schedule(RESET_CYCLES, 0x7FFFFFFF);
@@ -108,6 +109,9 @@ Core::Core(std::string ndsRom, std::string gbaRom, int id, int ndsRomFd, int gba
         // Load cheats if any exist
         actionReplay.loadCheats();
 
+        // Find the ARM9 overlays for profiling
+        profiler.init();
+
         // Prepare to boot the NDS ROM directly if direct boot is enabled
         if (Settings::directBoot) {
             // Set some registers as the BIOS/firmware would
@@ -144,6 +148,13 @@ Core::Core(std::string ndsRom, std::string gbaRom, int id, int ndsRomFd, int gba
         hleArm7.init();
     }
 
+    // Check if the ARM7 should run on its own thread for this game
+    if (!gbaMode)
+        arm7Thread.init(cartridgeNds.getRomCode());
+
+    // Start timing frames from boot rather than from the clock's epoch
+    frameStart = runEnd = lastFpsTime = std::chrono::steady_clock::now();
+
     // Let the core run
     running.store(true);
 }
@@ -163,6 +174,12 @@ void Core::saveState(FILE *file) {
 }
 
 void Core::loadState(FILE *file) {
+    // Movies replay from boot, so loading a state ends any that's in progress
+    if (movie.isActive()) {
+        LOG_WARN("Stopping movie because a state was loaded\n");
+        movie.stop();
+    }
+
     // Read state data from the file
     fread(&arm7Hle, sizeof(arm7Hle), 1, file);
     fread(&dsiMode, sizeof(dsiMode), 1, file);
@@ -176,13 +193,28 @@ void Core::loadState(FILE *file) {
     fread(&count, sizeof(count), 1, file);
     for (uint32_t i = 0; i < count; i++) {
         fread(&event, sizeof(event), 1, file);
-        events.push_back(event);
+        if (event.task != PROFILER_SAMPLE)
+            events.push_back(event);
     }
 
+    // Keep sampling if the profiler is running, regardless of the state it was in when saved
+    profiler.rearm();
+
     // Update the run function pointer
     updateRun();
 }
 
+void Core::runCore() {
+    // Run emulation until the end of the next frame, marking it for tracing
+    Trace::nameThread("Core");
+    TraceScope scope("runCore");
+
+    // Exclude time spent outside the core, such as while paused, from the frame being measured
+    frameStart += std::chrono::steady_clock::now() - runEnd;
+    (*runFunc)(*this);
+    runEnd = std::chrono::steady_clock::now();
+}
+
 void Core::updateRun() {
     // Set the run function based on active CPUs and core mode
     if (interpreter[0].halted && interpreter[1].halted)
@@ -192,7 +224,8 @@ void Core::updateRun() {
     else if (dsiMode)
         runFunc = &Interpreter::runCoreDsi;
     else if (!interpreter[0].halted && !interpreter[1].halted)
-        runFunc = &Interpreter::runCoreNds;
+        runFunc = arm7Thread.enabled ? &Interpreter::runCoreNdsThreaded :
+            (Settings::cpuQuantum ? &Interpreter::runCoreNdsQuantum : &Interpreter::runCoreNds);
     else if (interpreter[0].halted)
         runFunc = &Interpreter::runCoreSingle<true, 1>;
     else
@@ -206,6 +239,7 @@ void Core::resetCycles() {
         events[i].cycles -= globalCycles;
     for (int i = 0; i < 2; i++)
         interpreter[i].resetCycles(), timers[i].resetCycles();
+    wifi.resetCycles();
     globalCycles -= globalCycles;
     schedule(RESET_CYCLES, 0x7FFFFFFF);
 }
@@ -230,6 +264,9 @@ void Core::enterGbaMode() {
     schedule(GBA_SCANLINE308, 308 * 4);
     schedule(GBA_SPU_SAMPLE, 512);
 
+    // Keep sampling if the profiler is running, since its task was cleared with the rest
+    profiler.rearm();
+
     // Reset the system for GBA mode
     memory.updateMap7(0x00000000, 0xFFFFFFFF);
     interpreter[1].init();
@@ -261,6 +298,36 @@ void Core::endFrame() {
     if (arm7Hle)
         hleArm7.runFrame();
 
+    // Release latched input so it's sampled fresh in the next frame, unless a movie provides it
+    input.nextFrame();
+    movie.nextFrame();
+
+    // Report the most accessed I/O registers if counting them is enabled
+    if (Settings::ioProfiler)
+        profiler.reportIo();
+
+    // Measure the host time spent emulating the frame, excluding any throttling waits
+    // Let the GPU scale back rendering if this takes longer than a frame should
+    std::chrono::steady_clock::duration audioWait = spu.popWaitTime();
+    std::chrono::steady_clock::duration busyTime = std::chrono::steady_clock::now() - frameStart;
+    std::chrono::duration<double> workTime = busyTime - audioWait;
+    gpu.updateLoad(workTime.count() / framePacer.getPeriod());
+
+    // Record the frame's timing and what it spent time on
+    frameStats.endFrame(busyTime, audioWait);
+
+    // Throttle to the target frame rate if the frame pacer is enabled, or to the turbo speed if capped
+    if (turbo ? Settings::turboSpeed : (Settings::fpsLimiter && Settings::framePacer))
+        framePacer.waitFrame();
+    else
+        framePacer.reset();
+
+    // Estimate the emulation speed relative to real time, smoothed over several frames
+    std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+    std::chrono::duration<double> frameTime = frameEnd - frameStart;
+    speed += (framePacer.getBasePeriod() / std::max(frameTime.count(), 1e-6) - speed) / 16;
+    frameStart = frameEnd;
+
     // Update the FPS and reset the counter every second
     std::chrono::duration<double> fpsTime = std::chrono::steady_clock::now() - lastFpsTime;
     if (fpsTime.count() >= 1.0f) {
@@ -269,6 +336,9 @@ void Core::endFrame() {
         lastFpsTime = std::chrono::steady_clock::now();
     }
 
+    // Look for WiFi links with cores in other processes if enabled
+    wifiRemote.update();
+
     // Schedule WiFi updates only when needed
     if (wifi.shouldSchedule())
         wifi.scheduleInit();
@@ -26,12 +26,15 @@
 #include <vector>
 
 #include "action_replay.h"
+#include "arm7_thread.h"
 #include "cartridge.h"
 #include "cp15.h"
 #include "defines.h"
 #include "div_sqrt.h"
 #include "dldi.h"
 #include "dma.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
 #include "gpu.h"
 #include "gpu_2d.h"
 #include "gpu_3d.h"
@@ -42,13 +45,17 @@
 #include "interpreter.h"
 #include "ipc.h"
 #include "memory.h"
+#include "movie.h"
+#include "profiler.h"
 #include "rtc.h"
 #include "save_states.h"
 #include "settings.h"
 #include "spi.h"
 #include "spu.h"
 #include "timers.h"
+#include "trace.h"
 #include "wifi.h"
+#include "wifi_remote.h"
 
 enum CoreError {
     ERROR_BIOS,
@@ -89,6 +96,7 @@ enum SchedTask {
     WIFI_COUNT_MS,
     WIFI_TRANS_REPLY,
     WIFI_TRANS_ACK,
+    PROFILER_SAMPLE,
     MAX_TASKS
 };
 
@@ -104,17 +112,22 @@ class Core {
 public:
     int id = 0;
     int fps = 0;
+    double speed = 1.0;
+    std::atomic<bool> turbo = { false };
     bool arm7Hle = false;
     bool dsiMode = false;
     bool gbaMode = false;
 
     ActionReplay actionReplay;
+    Arm7Thread arm7Thread;
     CartridgeGba cartridgeGba;
     CartridgeNds cartridgeNds;
     Cp15 cp15;
     DivSqrt divSqrt;
     Dldi dldi;
     Dma dma[2];
+    FramePacer framePacer;
+    FrameStats frameStats;
     Gpu gpu;
     Gpu2D gpu2D[2];
     Gpu3D gpu3D;
@@ -125,24 +138,28 @@ public:
     Interpreter interpreter[2];
     Ipc ipc;
     Memory memory;
+    Movie movie;
+    Profiler profiler;
     Rtc rtc;
     SaveStates saveStates;
     Spi spi;
     Spu spu;
     Timers timers[2];
     Wifi wifi;
+    WifiRemote wifiRemote;
 
     std::atomic<bool> running;
     std::vector<SchedEvent> events;
     std::function<void()> tasks[MAX_TASKS];
     uint32_t globalCycles = 0;
+    bool cpuSync = false;
 
     Core(std::string ndsRom = "", std::string gbaRom = "", int id = 0, int ndsRomFd = -1, int gbaRomFd = -1,
         int ndsSaveFd = -1, int gbaSaveFd = -1, int ndsStateFd = -1, int gbaStateFd = -1, int ndsCheatFd = -1);
     void saveState(FILE *file);
     void loadState(FILE *file);
 
-    void runCore() { (*runFunc)(*this); }
+    void runCore();
     void schedule(SchedTask task, uint32_t cycles);
     void enterGbaMode();
     void endFrame();
@@ -151,6 +168,8 @@ private:
     bool realGbaBios;
     void (*runFunc)(Core&) = &Interpreter::runCoreNds;
     std::chrono::steady_clock::time_point lastFpsTime;
+    std::chrono::steady_clock::time_point frameStart;
+    std::chrono::steady_clock::time_point runEnd;
     int fpsCount = 0;
 
     void updateRun();
@@ -34,6 +34,7 @@ EVT_TIMER(UPDATE, NooApp::update)
 wxEND_EVENT_TABLE()
 
 int NooApp::micEnable = 0;
+int NooApp::perfHud = 0;
 int NooApp::splitScreens = 0;
 int NooApp::keyBinds[] = { 'L', 'K', 'G', 'H', 'D', 'A', 'W', 'S', 'P', 'Q', 'O', 'I', WXK_TAB, 0, WXK_ESCAPE, 0, WXK_BACK };
 
@@ -41,6 +42,7 @@ bool NooApp::OnInit() {
     // Define the platform settings
     std::vector<Setting> platformSettings = {
         Setting("micEnable", &micEnable, false),
+        Setting("perfHud", &perfHud, false),
         Setting("splitScreens", &splitScreens, false),
         Setting("keyA", &keyBinds[0], false),
         Setting("keyB", &keyBinds[1], false),
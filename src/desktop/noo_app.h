@@ -30,6 +30,7 @@ class NooFrame;
 class NooApp: public wxApp {
 public:
     static int micEnable;
+    static int perfHud;
     static int splitScreens;
     static int keyBinds[MAX_KEYS];
 
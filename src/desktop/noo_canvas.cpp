@@ -17,6 +17,7 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <wx/rawbmp.h>
 
 #include "noo_canvas.h"
@@ -29,6 +30,12 @@
 #include <GL/glext.h>
 #endif
 
+// Size and position of the performance HUD, with a graph column for each frame
+#define HUD_WIDTH 256
+#define HUD_HEIGHT 132
+#define HUD_GRAPH 80
+#define HUD_MARGIN 8
+
 wxBEGIN_EVENT_TABLE(NooCanvas, CANVAS_CLASS)
 EVT_PAINT(NooCanvas::draw)
 EVT_SIZE(NooCanvas::resize)
@@ -122,6 +129,88 @@ void NooCanvas::drawScreen(int x, int y, int w, int h, int wb, int hb, uint32_t
 #endif
 }
 
+void NooCanvas::drawHud() {
+    // Get recent frame times and other stats, which the core publishes without locking
+    HudFrame frames[HUD_WIDTH];
+    int count = frame->core->frameStats.getHudFrames(frames, HUD_WIDTH);
+    HudInfo info = frame->core->frameStats.getHudInfo();
+
+    // Prepare a bitmap for the HUD, scaling the graph so it fits two native frame periods
+    wxBitmap bmp(HUD_WIDTH, HUD_HEIGHT, 24);
+    wxMemoryDC dc(bmp);
+    dc.SetBackground(*wxBLACK_BRUSH);
+    dc.Clear();
+    float scale = HUD_GRAPH / (frame->core->framePacer.getBasePeriod() * 2000);
+    static const wxColour colors[] = { wxColour(64, 192, 64), wxColour(224, 64, 64),
+        wxColour(64, 128, 255), wxColour(224, 192, 64), wxColour(192, 64, 224) };
+
+    // Draw a bar for each frame with the time spent in each phase stacked, newest on the right
+    // Mark the time between frames being presented on top, and the frame budget as a line
+    for (int i = 0; i < count; i++) {
+        int x = HUD_WIDTH - count + i, y = HUD_GRAPH - 1;
+        for (int j = 0; j < MAX_PHASES && y >= 0; j++) {
+            int height = std::min<int>(frames[i].phases[j] * scale + 0.5f, y + 1);
+            if (height <= 0) continue;
+            dc.SetPen(wxPen(colors[j]));
+            dc.DrawLine(x, y, x, y - height);
+            y -= height;
+        }
+        dc.SetPen(*wxWHITE_PEN);
+        dc.DrawPoint(x, HUD_GRAPH - 1 - std::min<int>(frames[i].present * scale, HUD_GRAPH - 1));
+    }
+    dc.SetPen(wxPen(wxColour(160, 160, 160), 1, wxPENSTYLE_DOT));
+    dc.DrawLine(0, HUD_GRAPH / 2, HUD_WIDTH, HUD_GRAPH / 2);
+
+    // Draw a legend with each phase in its color
+    static const char *names[] = { "CPU", "3D", "2D", "Audio", "I/O", "Present" };
+    dc.SetFont(wxFont(8, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+    for (int i = 0, x = 4; i <= MAX_PHASES; i++) {
+        dc.SetTextForeground((i < MAX_PHASES) ? colors[i] : *wxWHITE);
+        dc.DrawText(names[i], x, HUD_GRAPH + 4);
+        x += dc.GetTextExtent(names[i]).x + 8;
+    }
+
+    // Draw the latest frame time, threading, and cache stats
+    float total = 0, present = 0;
+    if (count > 0) {
+        for (int i = 0; i < MAX_PHASES; i++)
+            total += frames[count - 1].phases[i];
+        present = frames[count - 1].present;
+    }
+    dc.SetTextForeground(*wxWHITE);
+    dc.DrawText(wxString::Format("Frame %.1fms, present %.1fms", total, present), 4, HUD_GRAPH + 16);
+    dc.DrawText(wxString::Format("Threads: 2D %d, 3D %d, ARM7 %s", info.threads2D,
+        info.threads3D, info.threadedArm7 ? "separate" : "shared"), 4, HUD_GRAPH + 28);
+    dc.DrawText(wxString::Format("Jump cache: ARM9 %.1f%%, ARM7 %.1f%%",
+        info.jumpHitRate[0], info.jumpHitRate[1]), 4, HUD_GRAPH + 40);
+    dc.SelectObject(wxNullBitmap);
+
+#ifdef USE_GL_CANVAS
+    // Draw the HUD translucently in the top-left corner
+    wxImage img = bmp.ConvertToImage();
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, HUD_WIDTH, HUD_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, img.GetData());
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4f(1.0f, 1.0f, 1.0f, 0.75f);
+    glBegin(GL_QUADS);
+    glTexCoord2i(0, 0);
+    glVertex2i(HUD_MARGIN, HUD_MARGIN);
+    glTexCoord2i(1, 0);
+    glVertex2i(HUD_MARGIN + HUD_WIDTH, HUD_MARGIN);
+    glTexCoord2i(1, 1);
+    glVertex2i(HUD_MARGIN + HUD_WIDTH, HUD_MARGIN + HUD_HEIGHT);
+    glTexCoord2i(0, 1);
+    glVertex2i(HUD_MARGIN, HUD_MARGIN + HUD_HEIGHT);
+    glEnd();
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glDisable(GL_BLEND);
+#else
+    // Draw the HUD in the top-left corner
+    wxPaintDC paintDc(this);
+    paintDc.DrawBitmap(bmp, wxPoint(HUD_MARGIN, HUD_MARGIN));
+#endif
+}
+
 void NooCanvas::draw(wxPaintEvent &event) {
     // Stop rendering if the program is closing
     if (finished)
@@ -173,6 +262,10 @@ void NooCanvas::draw(wxPaintEvent &event) {
                 drawScreen(layout.botX, layout.botY, layout.botWidth, layout.botHeight,
                    256 << shift, 192 << shift, &framebuffer[(256 * 192) << (shift * 2)]);
         }
+
+        // Draw the performance HUD over the screens if enabled
+        if (NooApp::perfHud && frame->mainFrame)
+            drawHud();
     }
 
     // Track the refresh rate and update the swap interval every second
@@ -62,6 +62,7 @@ private:
     std::chrono::steady_clock::time_point lastRateTime;
 
     void drawScreen(int x, int y, int w, int h, int wb, int hb, uint32_t *buf);
+    void drawHud();
 
     void draw(wxPaintEvent &event);
     void resize(wxSizeEvent &event);
@@ -26,6 +26,7 @@
 #include "path_dialog.h"
 #include "save_dialog.h"
 #include "../settings.h"
+#include "../trace.h"
 #include "../../icon/icon.xpm"
 
 enum FrameEvent {
@@ -41,15 +42,29 @@ enum FrameEvent {
     STOP,
     ACTION_REPLAY,
     ADD_SYSTEM,
+    RECORD_TRACE,
+    PROFILE_GUEST,
+    RECORD_MOVIE,
+    PLAY_MOVIE,
     DIRECT_BOOT,
     ROM_IN_RAM,
     FPS_LIMITER,
+    INPUT_LATCH,
+    FRAME_PACER_0,
+    FRAME_PACER_1,
+    FRAME_PACER_2,
+    FRAME_PACER_4,
+    TURBO_SPEED_0,
+    TURBO_SPEED_2,
+    TURBO_SPEED_3,
+    TURBO_SPEED_4,
     FRAMESKIP_0,
     FRAMESKIP_1,
     FRAMESKIP_2,
     FRAMESKIP_3,
     FRAMESKIP_4,
     FRAMESKIP_5,
+    ADAPTIVE_SKIP,
     THREADED_2D,
     THREADED_3D_0,
     THREADED_3D_1,
@@ -57,12 +72,23 @@ enum FrameEvent {
     THREADED_3D_3,
     THREADED_3D_4,
     HIGH_RES_3D,
+    ADAPTIVE_RES_3D,
     SCREEN_GHOST,
+    PERF_HUD,
     EMULATE_AUDIO,
     AUDIO_16_BIT,
     MIC_ENABLE,
     ARM7_HLE,
     DSI_MODE,
+    WIFI_LOCKSTEP,
+    WIFI_REMOTE,
+    CPU_QUANTUM_0,
+    CPU_QUANTUM_64,
+    CPU_QUANTUM_256,
+    CPU_QUANTUM_1024,
+    ARM7_THREAD_0,
+    ARM7_THREAD_1,
+    ARM7_THREAD_2,
     PATH_SETTINGS,
     SCREEN_LAYOUT,
     INPUT_BINDINGS,
@@ -82,15 +108,29 @@ EVT_MENU(RESTART, NooFrame::restart)
 EVT_MENU(STOP, NooFrame::stop)
 EVT_MENU(ACTION_REPLAY, NooFrame::actionReplay)
 EVT_MENU(ADD_SYSTEM, NooFrame::addSystem)
+EVT_MENU(RECORD_TRACE, NooFrame::recordTrace)
+EVT_MENU(PROFILE_GUEST, NooFrame::profileGuest)
+EVT_MENU(RECORD_MOVIE, NooFrame::recordMovie)
+EVT_MENU(PLAY_MOVIE, NooFrame::playMovie)
 EVT_MENU(DIRECT_BOOT, NooFrame::directBoot)
 EVT_MENU(ROM_IN_RAM, NooFrame::romInRam)
 EVT_MENU(FPS_LIMITER, NooFrame::fpsLimiter)
+EVT_MENU(INPUT_LATCH, NooFrame::inputLatch)
+EVT_MENU(FRAME_PACER_0, NooFrame::framePacer<0>)
+EVT_MENU(FRAME_PACER_1, NooFrame::framePacer<1>)
+EVT_MENU(FRAME_PACER_2, NooFrame::framePacer<2>)
+EVT_MENU(FRAME_PACER_4, NooFrame::framePacer<4>)
+EVT_MENU(TURBO_SPEED_0, NooFrame::turboSpeed<0>)
+EVT_MENU(TURBO_SPEED_2, NooFrame::turboSpeed<2>)
+EVT_MENU(TURBO_SPEED_3, NooFrame::turboSpeed<3>)
+EVT_MENU(TURBO_SPEED_4, NooFrame::turboSpeed<4>)
 EVT_MENU(FRAMESKIP_0, NooFrame::frameskip<0>)
 EVT_MENU(FRAMESKIP_1, NooFrame::frameskip<1>)
 EVT_MENU(FRAMESKIP_2, NooFrame::frameskip<2>)
 EVT_MENU(FRAMESKIP_3, NooFrame::frameskip<3>)
 EVT_MENU(FRAMESKIP_4, NooFrame::frameskip<4>)
 EVT_MENU(FRAMESKIP_5, NooFrame::frameskip<5>)
+EVT_MENU(ADAPTIVE_SKIP, NooFrame::adaptiveSkip)
 EVT_MENU(THREADED_2D, NooFrame::threaded2D)
 EVT_MENU(THREADED_3D_0, NooFrame::threaded3D<0>)
 EVT_MENU(THREADED_3D_1, NooFrame::threaded3D<1>)
@@ -98,12 +138,23 @@ EVT_MENU(THREADED_3D_2, NooFrame::threaded3D<2>)
 EVT_MENU(THREADED_3D_3, NooFrame::threaded3D<3>)
 EVT_MENU(THREADED_3D_4, NooFrame::threaded3D<4>)
 EVT_MENU(HIGH_RES_3D, NooFrame::highRes3D)
+EVT_MENU(ADAPTIVE_RES_3D, NooFrame::adaptiveRes3D)
 EVT_MENU(SCREEN_GHOST, NooFrame::screenGhost)
+EVT_MENU(PERF_HUD, NooFrame::perfHud)
 EVT_MENU(EMULATE_AUDIO, NooFrame::emulateAudio)
 EVT_MENU(AUDIO_16_BIT, NooFrame::audio16Bit)
 EVT_MENU(MIC_ENABLE, NooFrame::micEnable)
 EVT_MENU(ARM7_HLE, NooFrame::arm7Hle)
 EVT_MENU(DSI_MODE, NooFrame::dsiMode)
+EVT_MENU(CPU_QUANTUM_0, NooFrame::cpuQuantum<0>)
+EVT_MENU(CPU_QUANTUM_64, NooFrame::cpuQuantum<64>)
+EVT_MENU(CPU_QUANTUM_256, NooFrame::cpuQuantum<256>)
+EVT_MENU(CPU_QUANTUM_1024, NooFrame::cpuQuantum<1024>)
+EVT_MENU(ARM7_THREAD_0, NooFrame::arm7Thread<0>)
+EVT_MENU(ARM7_THREAD_1, NooFrame::arm7Thread<1>)
+EVT_MENU(ARM7_THREAD_2, NooFrame::arm7Thread<2>)
+EVT_MENU(WIFI_LOCKSTEP, NooFrame::wifiLockstep)
+EVT_MENU(WIFI_REMOTE, NooFrame::wifiRemote)
 EVT_MENU(PATH_SETTINGS, NooFrame::pathSettings)
 EVT_MENU(SCREEN_LAYOUT, NooFrame::layoutSettings)
 EVT_MENU(INPUT_BINDINGS, NooFrame::inputSettings)
@@ -140,6 +191,10 @@ NooFrame::NooFrame(NooApp *app, int id, std::string path, NooFrame *partner):
         systemMenu->AppendSeparator();
         systemMenu->Append(ACTION_REPLAY, "&Action Replay");
         systemMenu->Append(ADD_SYSTEM, "&Add System");
+        systemMenu->AppendCheckItem(RECORD_TRACE, "Record &Trace");
+        systemMenu->AppendCheckItem(PROFILE_GUEST, "&Profile Guest Code");
+        systemMenu->Append(RECORD_MOVIE, "Record &Movie");
+        systemMenu->Append(PLAY_MOVIE, "Play M&ovie");
 
         // Disable some menu items until the core is running
         fileMenu->Enable(TRIM_ROM, false);
@@ -150,6 +205,9 @@ NooFrame::NooFrame(NooApp *app, int id, std::string path, NooFrame *partner):
         systemMenu->Enable(RESTART, false);
         systemMenu->Enable(STOP, false);
         systemMenu->Enable(ACTION_REPLAY, false);
+        systemMenu->Enable(PROFILE_GUEST, false);
+        systemMenu->Enable(RECORD_MOVIE, false);
+        systemMenu->Enable(PLAY_MOVIE, false);
 
         // Set up the skip frames submenu
         wxMenu *frameskip = new wxMenu();
@@ -160,6 +218,20 @@ NooFrame::NooFrame(NooApp *app, int id, std::string path, NooFrame *partner):
         frameskip->AppendRadioItem(FRAMESKIP_4, "&4 Frames");
         frameskip->AppendRadioItem(FRAMESKIP_5, "&5 Frames");
 
+        // Set up the frame pacer submenu
+        wxMenu *framePacer = new wxMenu();
+        framePacer->AppendRadioItem(FRAME_PACER_0, "&Disabled");
+        framePacer->AppendRadioItem(FRAME_PACER_1, "&Native Speed");
+        framePacer->AppendRadioItem(FRAME_PACER_2, "&2x Speed");
+        framePacer->AppendRadioItem(FRAME_PACER_4, "&4x Speed");
+
+        // Set up the fast forward speed submenu
+        wxMenu *turboSpeed = new wxMenu();
+        turboSpeed->AppendRadioItem(TURBO_SPEED_2, "&2x Speed");
+        turboSpeed->AppendRadioItem(TURBO_SPEED_3, "&3x Speed");
+        turboSpeed->AppendRadioItem(TURBO_SPEED_4, "&4x Speed");
+        turboSpeed->AppendRadioItem(TURBO_SPEED_0, "&Unlimited");
+
         // Set up the threaded 3D submenu
         wxMenu *threaded3D = new wxMenu();
         threaded3D->AppendRadioItem(THREADED_3D_0, "&Disabled");
@@ -168,19 +240,38 @@ NooFrame::NooFrame(NooApp *app, int id, std::string path, NooFrame *partner):
         threaded3D->AppendRadioItem(THREADED_3D_3, "&3 Threads");
         threaded3D->AppendRadioItem(THREADED_3D_4, "&4 Threads");
 
+        // Set up the CPU interleaving submenu
+        wxMenu *cpuQuantum = new wxMenu();
+        cpuQuantum->AppendRadioItem(CPU_QUANTUM_0, "&Exact");
+        cpuQuantum->AppendRadioItem(CPU_QUANTUM_64, "&64 Cycles");
+        cpuQuantum->AppendRadioItem(CPU_QUANTUM_256, "&256 Cycles");
+        cpuQuantum->AppendRadioItem(CPU_QUANTUM_1024, "&1024 Cycles");
+
+        // Set up the threaded ARM7 submenu
+        wxMenu *arm7Thread = new wxMenu();
+        arm7Thread->AppendRadioItem(ARM7_THREAD_0, "&Disabled");
+        arm7Thread->AppendRadioItem(ARM7_THREAD_1, "&Listed Games");
+        arm7Thread->AppendRadioItem(ARM7_THREAD_2, "&All Games");
+
         // Set up the general settings submenu
         wxMenu *generalMenu = new wxMenu();
         generalMenu->AppendCheckItem(DIRECT_BOOT, "&Direct Boot");
         generalMenu->AppendCheckItem(ROM_IN_RAM, "&Keep ROM in RAM");
         generalMenu->AppendCheckItem(FPS_LIMITER, "&FPS Limiter");
+        generalMenu->AppendSubMenu(framePacer, "&Frame Pacer");
+        generalMenu->AppendSubMenu(turboSpeed, "Fast Forward &Speed");
+        generalMenu->AppendCheckItem(INPUT_LATCH, "Late &Input Latching");
 
         // Set up the graphics settings submenu
         wxMenu *graphicsMenu = new wxMenu();
         graphicsMenu->AppendSubMenu(frameskip, "&Skip Frames");
+        graphicsMenu->AppendCheckItem(ADAPTIVE_SKIP, "&Adaptive Frameskip");
         graphicsMenu->AppendCheckItem(THREADED_2D, "&Threaded 2D");
         graphicsMenu->AppendSubMenu(threaded3D, "&Threaded 3D");
         graphicsMenu->AppendCheckItem(HIGH_RES_3D, "&High-Resolution 3D");
+        graphicsMenu->AppendCheckItem(ADAPTIVE_RES_3D, "Adaptive 3D &Resolution");
         graphicsMenu->AppendCheckItem(SCREEN_GHOST, "Simulate Ghosting");
+        graphicsMenu->AppendCheckItem(PERF_HUD, "&Performance HUD");
 
         // Set up the audio settings submenu
         wxMenu *audioMenu = new wxMenu();
@@ -192,6 +283,10 @@ NooFrame::NooFrame(NooApp *app, int id, std::string path, NooFrame *partner):
         wxMenu *experiMenu = new wxMenu();
         experiMenu->AppendCheckItem(ARM7_HLE, "&High-Level ARM7");
         experiMenu->AppendCheckItem(DSI_MODE, "&DSi Homebrew Mode");
+        experiMenu->AppendCheckItem(WIFI_LOCKSTEP, "&WiFi Lockstep");
+        experiMenu->AppendCheckItem(WIFI_REMOTE, "&Cross-Process WiFi");
+        experiMenu->AppendSubMenu(cpuQuantum, "CPU &Interleaving");
+        experiMenu->AppendSubMenu(arm7Thread, "&Threaded ARM7");
 
         // Set up the settings menu
         wxMenu *settingsMenu = new wxMenu();
@@ -208,18 +303,45 @@ NooFrame::NooFrame(NooApp *app, int id, std::string path, NooFrame *partner):
         settingsMenu->Check(DIRECT_BOOT, Settings::directBoot);
         settingsMenu->Check(ROM_IN_RAM, Settings::romInRam);
         settingsMenu->Check(FPS_LIMITER, Settings::fpsLimiter);
+        settingsMenu->Check(INPUT_LATCH, Settings::inputLatch);
+        settingsMenu->Check(ADAPTIVE_SKIP, Settings::adaptiveSkip);
         settingsMenu->Check(THREADED_2D, Settings::threaded2D);
         settingsMenu->Check(HIGH_RES_3D, Settings::highRes3D);
+        settingsMenu->Check(ADAPTIVE_RES_3D, Settings::adaptiveRes3D);
         settingsMenu->Check(SCREEN_GHOST, Settings::screenGhost);
+        settingsMenu->Check(PERF_HUD, NooApp::perfHud);
         settingsMenu->Check(EMULATE_AUDIO, Settings::emulateAudio);
         settingsMenu->Check(AUDIO_16_BIT, Settings::audio16Bit);
         settingsMenu->Check(MIC_ENABLE, NooApp::micEnable);
         settingsMenu->Check(ARM7_HLE, Settings::arm7Hle);
         settingsMenu->Check(DSI_MODE, Settings::dsiMode);
+        settingsMenu->Check(WIFI_LOCKSTEP, Settings::wifiLockstep);
+        settingsMenu->Check(WIFI_REMOTE, Settings::wifiRemote);
 
         // Set the initial radio setting selections
         frameskip->Check(FRAMESKIP_0 + std::min<uint8_t>(Settings::frameskip, 5), true);
         threaded3D->Check(THREADED_3D_0 + std::min<uint8_t>(Settings::threaded3D, 4), true);
+        if (!Settings::framePacer) framePacer->Check(FRAME_PACER_0, true);
+        else if (Settings::pacerSpeed >= 400) framePacer->Check(FRAME_PACER_4, true);
+        else if (Settings::pacerSpeed >= 200) framePacer->Check(FRAME_PACER_2, true);
+        else framePacer->Check(FRAME_PACER_1, true);
+        switch (Settings::turboSpeed) {
+        case 0: turboSpeed->Check(TURBO_SPEED_0, true); break;
+        case 3: turboSpeed->Check(TURBO_SPEED_3, true); break;
+        case 4: turboSpeed->Check(TURBO_SPEED_4, true); break;
+        default: turboSpeed->Check(TURBO_SPEED_2, true); break;
+        }
+        switch (Settings::cpuQuantum) {
+        case 0: cpuQuantum->Check(CPU_QUANTUM_0, true); break;
+        case 64: cpuQuantum->Check(CPU_QUANTUM_64, true); break;
+        case 256: cpuQuantum->Check(CPU_QUANTUM_256, true); break;
+        default: cpuQuantum->Check(CPU_QUANTUM_1024, true); break;
+        }
+        switch (Settings::arm7Thread) {
+        case 0: arm7Thread->Check(ARM7_THREAD_0, true); break;
+        case 1: arm7Thread->Check(ARM7_THREAD_1, true); break;
+        default: arm7Thread->Check(ARM7_THREAD_2, true); break;
+        }
 
         // Set up the menu bar
         wxMenuBar *menuBar = new wxMenuBar();
@@ -277,6 +399,21 @@ void NooFrame::Refresh() {
     wxString label = "NooDS";
     if (id > 0) label += wxString::Format(" (%d)", id + 1);
     if (running) label += wxString::Format(" - %d FPS", core->fps);
+    if (running && Settings::fpsLimiter && Settings::framePacer)
+        label += wxString::Format(" (jitter %dus avg, %dus max)", core->framePacer.jitterAvg, core->framePacer.jitterMax);
+    if (running && Settings::inputLatch)
+        label += wxString::Format(" (input latency %dus avg)", core->input.latencyAvg);
+    if (running) {
+        // Show frame time percentiles, and what caused recent stutters if there were any
+        FrameReport report = core->frameStats.getReport();
+        label += wxString::Format(" (p50 %.1fms, p99 %.1fms", report.frameTime[0], report.frameTime[2]);
+        if (report.stutters)
+            label += wxString::Format(", %d stutters, mostly %s", report.stutters, FrameStats::getPhaseName(report.mainPhase));
+        label += ")";
+    }
+    if (running && core->turbo) label += wxString::Format(" - Turbo %.1fx", core->speed);
+    if (core && core->movie.getFailFrame() >= 0)
+        label += wxString::Format(" - Movie desynced at frame %d (%s)", int(core->movie.getFailFrame()), core->movie.getFailReason());
     SetLabel(label);
 
     // Manage the main frame's partner frame
@@ -326,6 +463,16 @@ void NooFrame::startCore(bool full) {
             core = new Core(ndsPath, gbaPath, id);
             if (partner) partner->core = core;
             app->connectCore(id);
+
+            // Start a pending movie before anything runs, so it covers emulation from boot
+            if (moviePath != "") {
+                if (!(movieRecord ? core->movie.startRecording(moviePath) : core->movie.startPlayback(moviePath)))
+                    wxMessageDialog(this, "Make sure the movie file is accessible and valid, and try again.",
+                        "Error Opening Movie", wxICON_NONE).ShowModal();
+                else if (core->movie.getWarning() != "")
+                    wxMessageDialog(this, core->movie.getWarning(), "Movie Settings Mismatch", wxICON_NONE).ShowModal();
+                moviePath = "";
+            }
         }
         catch (CoreError e) {
             // Inform the user of the error if loading wasn't successful
@@ -363,6 +510,9 @@ void NooFrame::startCore(bool full) {
         systemMenu->Enable(RESTART, true);
         systemMenu->Enable(STOP, true);
         systemMenu->Enable(ACTION_REPLAY, ndsPath != "");
+        systemMenu->Enable(PROFILE_GUEST, true);
+        systemMenu->Enable(RECORD_MOVIE, true);
+        systemMenu->Enable(PLAY_MOVIE, true);
 
         // Start the threads
         running = true;
@@ -406,6 +556,10 @@ void NooFrame::stopCore(bool full) {
         systemMenu->Enable(PAUSE, false);
         systemMenu->Enable(RESTART, false);
         systemMenu->Enable(STOP, false);
+        systemMenu->Enable(PROFILE_GUEST, false);
+        systemMenu->Check(PROFILE_GUEST, false);
+        systemMenu->Enable(RECORD_MOVIE, false);
+        systemMenu->Enable(PLAY_MOVIE, false);
 
         // Shut down the core
         if (core) {
@@ -421,27 +575,16 @@ void NooFrame::pressKey(int key) {
     // Handle a key press separate from the key's actual mapping
     switch (key) {
     case 12: // Fast Forward Hold
-        // Disable the FPS limiter
-        if (Settings::fpsLimiter != 0) {
-            fpsLimiterBackup = Settings::fpsLimiter;
-            Settings::fpsLimiter = 0;
-        }
+        // Enable turbo mode
+        if (running)
+            core->turbo = true;
         break;
 
     case 13: // Fast Forward Toggle
-        // Toggle the FPS limiter on or off
+        // Toggle turbo mode on or off
         if (!(hotkeyToggles & BIT(0))) {
-            if (Settings::fpsLimiter != 0) {
-                // Disable the FPS limiter
-                fpsLimiterBackup = Settings::fpsLimiter;
-                Settings::fpsLimiter = 0;
-            }
-            else if (fpsLimiterBackup != 0) {
-                // Restore the previous FPS limiter setting
-                Settings::fpsLimiter = fpsLimiterBackup;
-                fpsLimiterBackup = 0;
-            }
-
+            if (running)
+                core->turbo = !core->turbo;
             hotkeyToggles |= BIT(0);
         }
         break;
@@ -481,11 +624,9 @@ void NooFrame::releaseKey(int key) {
     // Handle a key release separate from the key's actual mapping
     switch (key) {
     case 12: // Fast Forward Hold
-        // Restore the previous FPS limiter setting
-        if (fpsLimiterBackup != 0) {
-            Settings::fpsLimiter = fpsLimiterBackup;
-            fpsLimiterBackup = 0;
-        }
+        // Disable turbo mode
+        if (running)
+            core->turbo = false;
         break;
 
     case 13: // Fast Forward Toggle
@@ -668,6 +809,74 @@ void NooFrame::addSystem(wxCommandEvent &event) {
     app->createFrame();
 }
 
+void NooFrame::recordTrace(wxCommandEvent &event) {
+    // Start recording trace events if not already
+    if (!Trace::enabled.load()) {
+        Trace::start();
+        return;
+    }
+
+    // Stop recording and save the events as a Chrome trace file
+    Trace::stop();
+    wxFileDialog traceSelect(this, "Save Trace File", "", "trace.json",
+        "Chrome trace files (*.json)|*.json", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (traceSelect.ShowModal() != wxID_CANCEL && !Trace::dump((const char*)traceSelect.GetPath().mb_str(wxConvUTF8)))
+        wxMessageDialog(this, "Make sure the trace file location is writable and try again.",
+            "Error Saving Trace", wxICON_NONE).ShowModal();
+}
+
+void NooFrame::profileGuest(wxCommandEvent &event) {
+    // Pause the core for safety, since the profiler schedules a task when starting
+    bool resume = running;
+    stopCore(false);
+
+    if (!core->profiler.isActive()) {
+        // Start sampling, using a map file next to the ROM for symbols if one exists
+        std::string path = (ndsPath != "") ? ndsPath : gbaPath;
+        std::string symbols = path.substr(0, path.rfind('.')) + ".sym";
+        if (path == "" || !wxFileExists(wxString::FromUTF8(symbols.c_str())))
+            symbols = "";
+        core->profiler.start(4096, symbols);
+    }
+    else {
+        // Stop sampling and save the results as folded stacks for flame graph tools
+        core->profiler.stop();
+        wxFileDialog profileSelect(this, "Save Profile File", "", "profile.folded",
+            "Folded stack files (*.folded)|*.folded", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+        if (profileSelect.ShowModal() != wxID_CANCEL && !core->profiler.dump((const char*)profileSelect.GetPath().mb_str(wxConvUTF8)))
+            wxMessageDialog(this, "Make sure the profile file location is writable and try again.",
+                "Error Saving Profile", wxICON_NONE).ShowModal();
+    }
+
+    if (resume) startCore(false);
+}
+
+void NooFrame::recordMovie(wxCommandEvent &event) {
+    // Show a file dialog for saving a movie
+    wxFileDialog movieSelect(this, "Record Movie", "", "movie.nmv",
+        "Movie files (*.nmv)|*.nmv", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (movieSelect.ShowModal() == wxID_CANCEL)
+        return;
+
+    // Restart the core so input is recorded from boot
+    moviePath = (const char*)movieSelect.GetPath().mb_str(wxConvUTF8);
+    movieRecord = true;
+    startCore(true);
+}
+
+void NooFrame::playMovie(wxCommandEvent &event) {
+    // Show a file dialog for selecting a movie
+    wxFileDialog movieSelect(this, "Play Movie", "", "",
+        "Movie files (*.nmv)|*.nmv", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+    if (movieSelect.ShowModal() == wxID_CANCEL)
+        return;
+
+    // Restart the core so input is replayed from boot
+    moviePath = (const char*)movieSelect.GetPath().mb_str(wxConvUTF8);
+    movieRecord = false;
+    startCore(true);
+}
+
 void NooFrame::directBoot(wxCommandEvent &event) {
     // Toggle the direct boot setting
     Settings::directBoot = !Settings::directBoot;
@@ -686,12 +895,51 @@ void NooFrame::fpsLimiter(wxCommandEvent &event) {
     Settings::save();
 }
 
+void NooFrame::inputLatch(wxCommandEvent &event) {
+    // Toggle the late input latching setting
+    Settings::inputLatch = !Settings::inputLatch;
+    Settings::save();
+}
+
+template <int value> void NooFrame::cpuQuantum(wxCommandEvent &event) {
+    // Set how many cycles a CPU can run ahead of the other, with 0 meaning exact interleaving
+    // This takes effect the next time a CPU halts or resumes
+    Settings::cpuQuantum = value;
+    Settings::save();
+}
+
+template <int value> void NooFrame::arm7Thread(wxCommandEvent &event) {
+    // Set whether the ARM7 runs on its own thread, either for games in the list or for all of them
+    // This takes effect the next time a game is started
+    Settings::arm7Thread = value;
+    Settings::save();
+}
+
+template <int value> void NooFrame::turboSpeed(wxCommandEvent &event) {
+    // Set the fast forward speed multiplier, with 0 meaning unlimited
+    Settings::turboSpeed = value;
+    Settings::save();
+}
+
+template <int value> void NooFrame::framePacer(wxCommandEvent &event) {
+    // Set the frame pacer setting, with a speed multiplier when enabled
+    Settings::framePacer = (value != 0);
+    if (value) Settings::pacerSpeed = value * 100;
+    Settings::save();
+}
+
 template <int value> void NooFrame::frameskip(wxCommandEvent &event) {
     // Set the skip frames setting
     Settings::frameskip = value;
     Settings::save();
 }
 
+void NooFrame::adaptiveSkip(wxCommandEvent &event) {
+    // Toggle the adaptive frameskip setting
+    Settings::adaptiveSkip = !Settings::adaptiveSkip;
+    Settings::save();
+}
+
 void NooFrame::threaded2D(wxCommandEvent &event) {
     // Toggle the threaded 2D setting
     Settings::threaded2D = !Settings::threaded2D;
@@ -710,12 +958,24 @@ void NooFrame::highRes3D(wxCommandEvent &event) {
     Settings::save();
 }
 
+void NooFrame::adaptiveRes3D(wxCommandEvent &event) {
+    // Toggle the adaptive 3D resolution setting
+    Settings::adaptiveRes3D = !Settings::adaptiveRes3D;
+    Settings::save();
+}
+
 void NooFrame::screenGhost(wxCommandEvent &event) {
     // Toggle the simulate ghosting setting
     Settings::screenGhost = !Settings::screenGhost;
     Settings::save();
 }
 
+void NooFrame::perfHud(wxCommandEvent &event) {
+    // Toggle the performance HUD setting
+    NooApp::perfHud = !NooApp::perfHud;
+    Settings::save();
+}
+
 void NooFrame::emulateAudio(wxCommandEvent &event) {
     // Toggle the audio emulation setting
     Settings::emulateAudio = !Settings::emulateAudio;
@@ -747,6 +1007,18 @@ void NooFrame::dsiMode(wxCommandEvent &event) {
     Settings::save();
 }
 
+void NooFrame::wifiLockstep(wxCommandEvent &event) {
+    // Toggle the WiFi lockstep setting
+    Settings::wifiLockstep = !Settings::wifiLockstep;
+    Settings::save();
+}
+
+void NooFrame::wifiRemote(wxCommandEvent &event) {
+    // Toggle the cross-process WiFi setting
+    Settings::wifiRemote = !Settings::wifiRemote;
+    Settings::save();
+}
+
 void NooFrame::pathSettings(wxCommandEvent &event) {
     // Show the path settings dialog
     PathDialog pathDialog;
@@ -53,13 +53,14 @@ private:
     int id;
 
     std::string ndsPath, gbaPath;
+    std::string moviePath;
+    bool movieRecord = false;
     std::thread *coreThread = nullptr, *saveThread = nullptr;
     std::condition_variable cond;
     std::mutex mutex;
 
     std::vector<int> axisBases;
     uint8_t hotkeyToggles = 0;
-    int fpsLimiterBackup = 0;
     bool fullScreen = false;
 
     void runCore();
@@ -78,19 +79,33 @@ private:
     void stop(wxCommandEvent &event);
     void actionReplay(wxCommandEvent &event);
     void addSystem(wxCommandEvent &event);
+    void recordTrace(wxCommandEvent &event);
+    void profileGuest(wxCommandEvent &event);
+    void recordMovie(wxCommandEvent &event);
+    void playMovie(wxCommandEvent &event);
     void directBoot(wxCommandEvent &event);
     void romInRam(wxCommandEvent &event);
     void fpsLimiter(wxCommandEvent &event);
+    void inputLatch(wxCommandEvent &event);
+    template <int> void framePacer(wxCommandEvent &event);
+    template <int> void turboSpeed(wxCommandEvent &event);
+    template <int> void cpuQuantum(wxCommandEvent &event);
+    template <int> void arm7Thread(wxCommandEvent &event);
     template <int> void frameskip(wxCommandEvent &event);
+    void adaptiveSkip(wxCommandEvent &event);
     void threaded2D(wxCommandEvent &event);
     template <int> void threaded3D(wxCommandEvent &event);
     void highRes3D(wxCommandEvent &event);
+    void adaptiveRes3D(wxCommandEvent &event);
     void screenGhost(wxCommandEvent &event);
+    void perfHud(wxCommandEvent &event);
     void emulateAudio(wxCommandEvent &event);
     void audio16Bit(wxCommandEvent &event);
     void micEnable(wxCommandEvent &event);
     void arm7Hle(wxCommandEvent &event);
     void dsiMode(wxCommandEvent &event);
+    void wifiLockstep(wxCommandEvent &event);
+    void wifiRemote(wxCommandEvent &event);
     void pathSettings(wxCommandEvent &event);
     void layoutSettings(wxCommandEvent &event);
     void inputSettings(wxCommandEvent &event);
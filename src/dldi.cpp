@@ -96,8 +96,11 @@ int Dldi::readSectors(bool arm7, uint32_t sector, uint32_t numSectors, uint32_t
 
     // Read data from the SD image
     uint8_t *data = new uint8_t[size];
-    fseek(sdImage, offset, SEEK_SET);
-    fread(data, sizeof(uint8_t), size, sdImage);
+    {
+        WaitTimer timer(core->frameStats, PHASE_IO);
+        fseek(sdImage, offset, SEEK_SET);
+        fread(data, sizeof(uint8_t), size, sdImage);
+    }
 
     // Write the data to memory
     for (int i = 0; i < size; i++)
@@ -118,8 +121,11 @@ int Dldi::writeSectors(bool arm7, uint32_t sector, uint32_t numSectors, uint32_t
         data[i] = core->memory.read<uint8_t>(arm7, buf + i);
 
     // Write the data to the SD image
-    fseek(sdImage, offset, SEEK_SET);
-    fwrite(data, sizeof(uint8_t), size, sdImage);
+    {
+        WaitTimer timer(core->frameStats, PHASE_IO);
+        fseek(sdImage, offset, SEEK_SET);
+        fwrite(data, sizeof(uint8_t), size, sdImage);
+    }
     delete[] data;
     return 1;
 }
@@ -0,0 +1,92 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <thread>
+
+#include "core.h"
+
+// Wake up this far ahead of a frame deadline and spin for the rest
+#define SPIN_MARGIN std::chrono::microseconds(1000)
+
+double FramePacer::getBasePeriod() {
+    // Get the length of a frame in seconds at native speed
+    // The NDS runs 560190 cycles per frame at 33513982Hz (~59.8261Hz)
+    // The GBA runs 280896 cycles per frame at 16777216Hz (~59.7275Hz)
+    return core->gbaMode ? (280896.0 / 16777216) : (560190.0 / 33513982);
+}
+
+double FramePacer::getPeriod() {
+    // Get the length of a frame in seconds, scaled by the turbo or pacing target speed
+    if (core->turbo && Settings::turboSpeed)
+        return getBasePeriod() / Settings::turboSpeed;
+    if (Settings::framePacer)
+        return getBasePeriod() * 100 / std::max(Settings::pacerSpeed, 1);
+    return getBasePeriod();
+}
+
+void FramePacer::waitFrame() {
+    // Start timing from the current frame if the pacer was just enabled
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> period(getPeriod());
+    if (!started) {
+        deadline = now;
+        lastStatTime = now;
+        started = true;
+        return;
+    }
+
+    // Advance the deadline by a frame, and check if emulation is running behind
+    deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+    if (now >= deadline) {
+        // Allow a frame of lateness to be caught up, but drop any debt beyond that
+        // This prevents a burst of unthrottled frames after a stall
+        if (now - deadline > period)
+            deadline = now;
+        updateStats(std::chrono::duration_cast<std::chrono::microseconds>(now - deadline).count(), true);
+        return;
+    }
+
+    // Sleep with the OS until shortly before the deadline, since its timing is coarse
+    if (deadline - now > SPIN_MARGIN)
+        std::this_thread::sleep_until(deadline - SPIN_MARGIN);
+
+    // Spin for the remaining time to hit the deadline precisely
+    while ((now = std::chrono::steady_clock::now()) < deadline);
+    updateStats(std::chrono::duration_cast<std::chrono::microseconds>(now - deadline).count(), false);
+}
+
+void FramePacer::updateStats(int jitter, bool late) {
+    // Accumulate the distance from each frame deadline in microseconds
+    jitterSum += jitter;
+    jitterPeak = std::max(jitterPeak, jitter);
+    jitterCount++;
+    lateCount += late;
+
+    // Update the jitter statistics and reset the counters every second
+    std::chrono::duration<double> statTime = std::chrono::steady_clock::now() - lastStatTime;
+    if (statTime.count() >= 1.0f) {
+        jitterAvg = jitterSum / jitterCount;
+        jitterMax = jitterPeak;
+        lateFrames = lateCount;
+        LOG_INFO("Frame pacer jitter: %dus average, %dus max, %d late frames\n", jitterAvg, jitterMax, lateFrames);
+        jitterSum = jitterPeak = jitterCount = lateCount = 0;
+        lastStatTime = std::chrono::steady_clock::now();
+    }
+}
@@ -0,0 +1,52 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+class Core;
+
+class FramePacer {
+public:
+    int jitterAvg = 0;
+    int jitterMax = 0;
+    int lateFrames = 0;
+
+    FramePacer(Core *core): core(core) {}
+
+    void reset() { started = false; }
+    void waitFrame();
+    double getBasePeriod();
+    double getPeriod();
+
+private:
+    Core *core;
+    bool started = false;
+    std::chrono::steady_clock::time_point deadline;
+
+    std::chrono::steady_clock::time_point lastStatTime;
+    int64_t jitterSum = 0;
+    int jitterPeak = 0;
+    int jitterCount = 0;
+    int lateCount = 0;
+
+    void updateStats(int jitter, bool late);
+};
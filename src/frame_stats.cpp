@@ -0,0 +1,167 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "core.h"
+
+// A frame that takes this much longer than its budget is counted as a stutter
+#define STUTTER_FACTOR 1.5
+
+// Gaps longer than this in seconds are assumed to be from pausing, and aren't recorded
+#define PAUSE_GAP 1.0
+
+void FrameStats::addWait(FramePhase phase, std::chrono::steady_clock::duration time) {
+    // Accumulate time spent waiting in a phase, which can happen on any thread
+    waits[phase].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+}
+
+void FrameStats::endFrame(std::chrono::steady_clock::duration frameTime, std::chrono::steady_clock::duration audioWait) {
+    // Collect the time spent in each phase during the frame, in seconds
+    double phases[MAX_PHASES];
+    for (int i = PHASE_3D; i < MAX_PHASES; i++)
+        phases[i] = waits[i].exchange(0) / 1000000000.0;
+    phases[PHASE_AUDIO] = std::chrono::duration<double>(audioWait).count();
+
+    // Publish the current thread counts and jump cache hit rates for the HUD
+    // Jump cache lookups are only counted while the HUD is reading them, to keep them off the hot path otherwise
+    bool hud = hudActive.exchange(false, std::memory_order_relaxed);
+    threads2D.store(core->gpu.getThreadCount(), std::memory_order_relaxed);
+    threads3D.store(core->gpu3DRenderer.getThreadCount(), std::memory_order_relaxed);
+    threadedArm7.store(core->arm7Thread.enabled, std::memory_order_relaxed);
+    for (int i = 0; i < 2; i++) {
+        uint32_t lookups, misses;
+        core->interpreter[i].takeJumpStats(lookups, misses);
+        if (lookups) jumpHitRate[i].store(100.0f * (lookups - misses) / lookups, std::memory_order_relaxed);
+        core->interpreter[i].setJumpStats(hud);
+    }
+
+    // Skip the first frame after a pause, since its time includes the pause
+    double total = std::chrono::duration<double>(frameTime).count();
+    if (total > PAUSE_GAP) return;
+
+    // Exclude 3D waits from 2D waits, since threaded 2D waits on 3D scanlines and the core waits on that
+    // Whatever remains of the frame is attributed to emulating the CPUs and hardware
+    phases[PHASE_2D] = std::max(0.0, phases[PHASE_2D] - phases[PHASE_3D]);
+    phases[PHASE_CPU] = total;
+    for (int i = PHASE_3D; i < MAX_PHASES; i++)
+        phases[PHASE_CPU] -= phases[i];
+    phases[PHASE_CPU] = std::max(0.0, phases[PHASE_CPU]);
+
+    // Publish the phase times in microseconds to the HUD, releasing them with the new frame count
+    uint32_t slot = hudFrameCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < MAX_PHASES; i++)
+        hudPhases[slot % HUD_HISTORY][i].store(phases[i] * 1000000, std::memory_order_relaxed);
+    hudFrameCount.store(slot + 1, std::memory_order_release);
+
+    // Check if the frame took too long, excluding audio waits since those throttle the emulator
+    // Attribute a stutter to the phase that took the most time during the frame
+    double period = core->framePacer.getPeriod();
+    bool over = (total - phases[PHASE_AUDIO] > period);
+    int phase = -1;
+    if (total > period * STUTTER_FACTOR)
+        phase = std::max_element(phases, phases + MAX_PHASES) - phases;
+
+    // Record the frame in the rolling history
+    std::lock_guard<std::mutex> guard(mutex);
+    int i = frameCount++ % HISTORY;
+    frameTimes[i] = total * 1000;
+    framePhases[i] = phase;
+    frameOver[i] = over;
+    if (phase != -1)
+        LOG_INFO("Stutter: frame took %.2fms, mostly %s\n", total * 1000, getPhaseName((FramePhase)phase));
+}
+
+void FrameStats::present() {
+    // Record the interval between frames being shown by the frontend, skipping pauses
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> interval = now - lastPresent;
+    if (interval.count() <= PAUSE_GAP) {
+        uint32_t slot = hudPresentCount.load(std::memory_order_relaxed);
+        hudPresents[slot % HUD_HISTORY].store(interval.count() * 1000000, std::memory_order_relaxed);
+        hudPresentCount.store(slot + 1, std::memory_order_release);
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    if (interval.count() <= PAUSE_GAP)
+        presentTimes[presentCount++ % HISTORY] = interval.count() * 1000;
+    lastPresent = now;
+}
+
+FrameReport FrameStats::getReport() {
+    // Summarize the frames in the rolling history
+    FrameReport report;
+    std::lock_guard<std::mutex> guard(mutex);
+    int frames = std::min(frameCount, HISTORY);
+    getPercentiles(frameTimes, frames, report.frameTime);
+    getPercentiles(presentTimes, std::min(presentCount, HISTORY), report.presentTime);
+    for (int i = 0; i < frames; i++) {
+        report.overBudget += frameOver[i];
+        if (framePhases[i] == -1) continue;
+        report.stutters++;
+        report.phaseStutters[framePhases[i]]++;
+    }
+
+    // Find the phase responsible for the most stutters
+    report.mainPhase = (FramePhase)(std::max_element(report.phaseStutters, report.phaseStutters + MAX_PHASES) - report.phaseStutters);
+    return report;
+}
+
+int FrameStats::getHudFrames(HudFrame *out, int count) {
+    // Get up to the given number of recent frames, oldest first, pairing each with a recent presentation
+    // Slots can be overwritten while reading, but with this much history that only happens after a long stall
+    uint32_t frames = hudFrameCount.load(std::memory_order_acquire);
+    uint32_t presents = hudPresentCount.load(std::memory_order_acquire);
+    count = std::min<uint32_t>(std::min<uint32_t>(count, HUD_HISTORY), frames);
+    for (int i = 0; i < count; i++) {
+        uint32_t age = count - i;
+        for (int j = 0; j < MAX_PHASES; j++)
+            out[i].phases[j] = hudPhases[(frames - age) % HUD_HISTORY][j].load(std::memory_order_relaxed) / 1000.0f;
+        out[i].present = (presents >= age) ? hudPresents[(presents - age) % HUD_HISTORY].load(std::memory_order_relaxed) / 1000.0f : 0;
+    }
+    return count;
+}
+
+HudInfo FrameStats::getHudInfo() {
+    // Get the latest thread counts and jump cache hit rates, and keep the hit rates updating
+    hudActive.store(true, std::memory_order_relaxed);
+    HudInfo info;
+    info.threads2D = threads2D.load(std::memory_order_relaxed);
+    info.threads3D = threads3D.load(std::memory_order_relaxed);
+    info.threadedArm7 = threadedArm7.load(std::memory_order_relaxed);
+    for (int i = 0; i < 2; i++)
+        info.jumpHitRate[i] = jumpHitRate[i].load(std::memory_order_relaxed);
+    return info;
+}
+
+const char *FrameStats::getPhaseName(FramePhase phase) {
+    // Get a short name for a frame phase
+    static const char *names[] = { "CPU", "3D wait", "2D wait", "audio wait", "file I/O" };
+    return names[phase];
+}
+
+void FrameStats::getPercentiles(float *times, int count, float *out) {
+    // Get the 50th, 95th, and 99th percentiles of a set of times
+    if (!count) return;
+    float sorted[HISTORY];
+    std::copy(times, times + count, sorted);
+    std::sort(sorted, sorted + count);
+    out[0] = sorted[(count - 1) * 50 / 100];
+    out[1] = sorted[(count - 1) * 95 / 100];
+    out[2] = sorted[(count - 1) * 99 / 100];
+}
@@ -0,0 +1,113 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+class Core;
+
+enum FramePhase {
+    PHASE_CPU = 0,
+    PHASE_3D,
+    PHASE_2D,
+    PHASE_AUDIO,
+    PHASE_IO,
+    MAX_PHASES
+};
+
+struct FrameReport {
+    float frameTime[3] = {}; // p50, p95, p99 in milliseconds
+    float presentTime[3] = {}; // p50, p95, p99 in milliseconds
+    int overBudget = 0;
+    int stutters = 0;
+    int phaseStutters[MAX_PHASES] = {};
+    FramePhase mainPhase = PHASE_CPU;
+};
+
+struct HudFrame {
+    float phases[MAX_PHASES] = {}; // Milliseconds spent in each phase
+    float present = 0; // Milliseconds since the previous frame was shown
+};
+
+struct HudInfo {
+    int threads2D = 0;
+    int threads3D = 0;
+    bool threadedArm7 = false;
+    float jumpHitRate[2] = {}; // Percentage of jump targets found in each CPU's cache
+};
+
+class FrameStats {
+public:
+    FrameStats(Core *core): core(core) {}
+
+    void addWait(FramePhase phase, std::chrono::steady_clock::duration time);
+    void endFrame(std::chrono::steady_clock::duration frameTime, std::chrono::steady_clock::duration audioWait);
+    void present();
+
+    FrameReport getReport();
+    int getHudFrames(HudFrame *out, int count);
+    HudInfo getHudInfo();
+    static const char *getPhaseName(FramePhase phase);
+
+private:
+    static const int HISTORY = 600;
+    static const int HUD_HISTORY = 256;
+
+    Core *core;
+    std::mutex mutex;
+    std::atomic<int64_t> waits[MAX_PHASES] = {};
+
+    float frameTimes[HISTORY] = {};
+    int8_t framePhases[HISTORY] = {};
+    bool frameOver[HISTORY] = {};
+    int frameCount = 0;
+
+    float presentTimes[HISTORY] = {};
+    int presentCount = 0;
+    std::chrono::steady_clock::time_point lastPresent;
+
+    // Recent data for the HUD, which is published without locking so the emulation thread never waits on it
+    std::atomic<uint32_t> hudPhases[HUD_HISTORY][MAX_PHASES] = {};
+    std::atomic<uint32_t> hudPresents[HUD_HISTORY] = {};
+    std::atomic<uint32_t> hudFrameCount = { 0 };
+    std::atomic<uint32_t> hudPresentCount = { 0 };
+    std::atomic<int> threads2D = { 0 };
+    std::atomic<int> threads3D = { 0 };
+    std::atomic<bool> threadedArm7 = { false };
+    std::atomic<float> jumpHitRate[2] = {};
+    std::atomic<bool> hudActive = { false };
+
+    static void getPercentiles(float *times, int count, float *out);
+};
+
+class WaitTimer {
+public:
+    WaitTimer(FrameStats &stats, FramePhase phase):
+        stats(stats), phase(phase), start(std::chrono::steady_clock::now()) {}
+    ~WaitTimer() { stats.addWait(phase, std::chrono::steady_clock::now() - start); }
+
+private:
+    FrameStats &stats;
+    FramePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
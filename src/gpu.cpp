@@ -17,6 +17,7 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cstring>
 #include "core.h"
 
@@ -60,6 +61,66 @@ void Gpu::loadState(FILE *file) {
     fread(&powCnt1, sizeof(powCnt1), 1, file);
 }
 
+void Gpu::updateLoad(double load) {
+    // Drop any adaptive changes that are no longer enabled
+    if (!Settings::adaptiveSkip) skipFrames = 0;
+    if (!Settings::adaptiveRes3D) lowRes3D = false;
+    if (!Settings::adaptiveSkip && !Settings::adaptiveRes3D) return;
+
+    // Smooth the load (frame time over real frame time) so single spikes don't cause changes
+    avgLoad += (load - avgLoad) / 8;
+
+    if (avgLoad > 1.0) {
+        // Reduce rendering work if emulation has been falling behind real time
+        // Upscaled 3D is dropped first since it's the most expensive, then frames are skipped
+        if (loadCount < 0) loadCount = 0;
+        if (++loadCount < 15) return;
+        loadCount = 0;
+
+        if (Settings::adaptiveRes3D && Settings::highRes3D && !lowRes3D) {
+            lowRes3D = true;
+            LOG_INFO("Adaptive rendering: dropping 3D to native resolution\n");
+        }
+        else if (Settings::adaptiveSkip && skipFrames < 4) {
+            skipFrames++;
+            LOG_INFO("Adaptive rendering: skipping %d frame(s)\n", skipFrames);
+        }
+    }
+    else if (avgLoad < 0.75) {
+        // Restore rendering work once there's been headroom for a while
+        // This waits longer than reducing does to avoid oscillating between states
+        if (loadCount > 0) loadCount = 0;
+        if (--loadCount > -120) return;
+        loadCount = 0;
+
+        if (skipFrames > 0) {
+            skipFrames--;
+            LOG_INFO("Adaptive rendering: skipping %d frame(s)\n", skipFrames);
+        }
+        else if (lowRes3D) {
+            lowRes3D = false;
+            LOG_INFO("Adaptive rendering: restoring 3D upscaling\n");
+        }
+    }
+    else {
+        // Hold the current state while the load is within bounds
+        loadCount = 0;
+    }
+}
+
+bool Gpu::isHighRes3D() {
+    // Check if 3D should be upscaled, unless it was dropped due to load
+    return Settings::highRes3D && !lowRes3D;
+}
+
+int Gpu::getFrameskip() {
+    // Get the number of frames to skip, treating the user setting as a minimum
+    // In turbo mode, intermediate frames are skipped so presentation stays near native speed
+    int skip = std::max(Settings::frameskip, skipFrames);
+    if (core->turbo) skip = std::max(skip, std::min(int(core->speed + 0.5) - 1, 9));
+    return skip;
+}
+
 uint32_t Gpu::rgb5ToRgb8(uint32_t color) {
     // Convert an RGB5 value to an RGB8 value, with RGB6 as an intermediate
     uint8_t r = (((color >> 0) & 0x1F) << 1) * 255 / 63;
@@ -88,6 +149,8 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop) {
     // Check if a new frame is ready
     if (!ready.load())
         return false;
+    TraceScope scope("getFrame");
+    core->frameStats.present();
 
     // Get the next queued buffers
     Buffers &buffers = framebuffers.front();
@@ -207,6 +270,10 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop) {
         }
     }
 
+    // Report latency from an input change to its frame being displayed
+    if (buffers.inputTime)
+        core->input.reportLatency(buffers.inputTime);
+
     // Remove the frame from the queue
     mutex.lock();
     framebuffers.pop();
@@ -217,8 +284,9 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop) {
 
 void Gpu::gbaScanline240() {
     if (vCount < 160) {
-        if (thread) {
+        if (thread && drawing.load() != 0) {
             // Wait for the thread to finish the scanline
+            WaitTimer timer(core->frameStats, PHASE_2D);
             while (drawing.load() != 0)
                 std::this_thread::yield();
         }
@@ -274,6 +342,9 @@ void Gpu::gbaScanline308() {
             buffers.framebuffer = new uint32_t[256 * 160];
             memcpy(buffers.framebuffer, core->gpu2D[0].getFramebuffer(), 256 * 160 * sizeof(uint32_t));
 
+            // Tag the frame with any input change it reflects, to measure latency
+            buffers.inputTime = core->input.takeChangeTime();
+
             // Add the frame to the queue
             mutex.lock();
             framebuffers.push(buffers);
@@ -282,7 +353,7 @@ void Gpu::gbaScanline308() {
         }
 
         // Update the frame count to skip frames when non-zero
-        if (frames++ >= Settings::frameskip)
+        if (frames++ >= getFrameskip())
             frames = 0;
 
         // Stop execution here in case the frontend needs to do things
@@ -333,22 +404,23 @@ void Gpu::gbaScanline308() {
 }
 
 void Gpu::scanline256() {
+    TraceScope scope("scanline256");
     if (vCount < 192) {
         if (thread) {
             // Make sure the thread has started before changing the state
             while (drawing.load() == 1)
                 std::this_thread::yield();
 
-            switch (drawing.exchange(3)) {
-            case 2:
-                // Draw engine B's scanline if it hasn't started yet (and purposely fall through)
+            // Draw engine B's scanline if it hasn't started yet
+            int state = drawing.exchange(3);
+            if (state == 2)
                 core->gpu2D[1].drawScanline(vCount);
 
-            case 3:
-                // Wait for the thread to finish the scanlines
+            // Wait for the thread to finish the scanlines if it was drawing them
+            if (state >= 2 && drawing.load() != 0) {
+                WaitTimer timer(core->frameStats, PHASE_2D);
                 while (drawing.load() != 0)
                     std::this_thread::yield();
-                break;
             }
         }
         else if (frames == 0) {
@@ -356,6 +428,10 @@ void Gpu::scanline256() {
             core->gpu2D[0].drawScanline(vCount);
             core->gpu2D[1].drawScanline(vCount);
         }
+        else if (dispCapCnt & BIT(31)) {
+            // Draw engine A's scanline on skipped frames so a display capture stays correct
+            core->gpu2D[0].drawScanline(vCount);
+        }
 
         // Trigger H-blank DMA transfers for visible scanlines (ARM9 only)
         core->dma[0].trigger(2);
@@ -382,7 +458,7 @@ void Gpu::scanline256() {
                 // Choose from 2D engine A or the 3D engine
                 // In high-res mode, skip every other pixel when capturing 3D
                 uint32_t *source = (dispCapCnt & BIT(24)) ? core->gpu3DRenderer.getLine(vCount) : core->gpu2D[0].getRawLine();
-                bool resShift = (Settings::highRes3D && (dispCapCnt & BIT(24)));
+                bool resShift = (isHighRes3D() && (dispCapCnt & BIT(24)));
 
                 // Copy a scanline to memory
                 for (int i = 0; i < width; i++)
@@ -416,7 +492,7 @@ void Gpu::scanline256() {
                 // Choose from 2D engine A or the 3D engine
                 // In high-res mode, skip every other pixel when capturing 3D
                 uint32_t *source = (dispCapCnt & BIT(24)) ? core->gpu3DRenderer.getLine(vCount) : core->gpu2D[0].getRawLine();
-                bool resShift = (Settings::highRes3D && (dispCapCnt & BIT(24)));
+                bool resShift = (isHighRes3D() && (dispCapCnt & BIT(24)));
 
                 // Get the VRAM source address for the current scanline
                 uint32_t readOffset = ((dispCapCnt & 0x0C000000) >> 11) + vCount * width * 2;
@@ -453,7 +529,8 @@ void Gpu::scanline256() {
     // Draw 3D scanlines 48 lines in advance, if the current 3D is dirty
     // If the 3D parameters haven't changed since the last frame, there's no need to draw it again
     // Bit 0 of the dirty variable represents invalidation, and bit 1 represents a frame currently drawing
-    if (frames == 0 && dirty3D && (core->gpu2D[0].readDispCnt() & BIT(3)) && ((vCount + 48) % 263) < 192) {
+    // 3D is still drawn on skipped frames if a display capture needs it
+    if ((frames == 0 || (dispCapCnt & BIT(31))) && dirty3D && (core->gpu2D[0].readDispCnt() & BIT(3)) && ((vCount + 48) % 263) < 192) {
         if (vCount == 215) dirty3D = BIT(1);
         core->gpu3DRenderer.drawScanline((vCount + 48) % 263);
         if (vCount == 143) dirty3D &= ~BIT(1);
@@ -473,6 +550,7 @@ void Gpu::scanline256() {
 }
 
 void Gpu::scanline355() {
+    TraceScope scope("scanline355");
     // Move to the next scanline
     switch (++vCount) {
     case 192: // End of visible scanlines
@@ -520,12 +598,15 @@ void Gpu::scanline355() {
             }
 
             // Copy the upscaled 3D output to a new buffer if enabled
-            if (Settings::highRes3D && (core->gpu2D[0].readDispCnt() & BIT(3))) {
+            if (isHighRes3D() && (core->gpu2D[0].readDispCnt() & BIT(3))) {
                 buffers.hiRes3D = new uint32_t[256 * 192 * 4];
                 memcpy(buffers.hiRes3D, core->gpu3DRenderer.getLine(0), 256 * 192 * 4 * sizeof(uint32_t));
                 buffers.top3D = (powCnt1 & BIT(15));
             }
 
+            // Tag the frame with any input change it reflects, to measure latency
+            buffers.inputTime = core->input.takeChangeTime();
+
             // Add the frame to the queue
             mutex.lock();
             framebuffers.push(buffers);
@@ -534,7 +615,7 @@ void Gpu::scanline355() {
         }
 
         // Update the frame count to skip frames when non-zero
-        if (frames++ >= Settings::frameskip)
+        if (frames++ >= getFrameskip())
             frames = 0;
 
         // Apply cheats and stop execution in case the frontend needs to do things
@@ -554,8 +635,8 @@ void Gpu::scanline355() {
         core->gpu2D[0].reloadRegisters();
         core->gpu2D[1].reloadRegisters();
 
-        // Start the 2D thread if enabled
-        if (Settings::threaded2D && frames == 0 && !thread) {
+        // Start the 2D thread if enabled, including on skipped frames with a display capture
+        if (Settings::threaded2D && (frames == 0 || (dispCapCnt & BIT(31))) && !thread) {
             running.store(true);
             thread = new std::thread(&Gpu::drawThreaded, this);
         }
@@ -610,6 +691,7 @@ void Gpu::drawGbaThreaded() {
 }
 
 void Gpu::drawThreaded() {
+    Trace::nameThread("GPU 2D");
     while (running.load()) {
         // Wait until the next scanline should start
         while (drawing.load() != 1) {
@@ -618,6 +700,7 @@ void Gpu::drawThreaded() {
         }
 
         // Draw engine A's scanline
+        TraceScope scope("drawThreaded");
         drawing.store(2);
         core->gpu2D[0].drawScanline(vCount);
 
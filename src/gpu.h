@@ -40,6 +40,10 @@ public:
     bool getFrame(uint32_t *out, bool gbaCrop);
     void invalidate3D() { dirty3D |= BIT(0); }
 
+    void updateLoad(double load);
+    bool isHighRes3D();
+    int getThreadCount() { return thread != nullptr; }
+
     void gbaScanline240();
     void gbaScanline308();
     void scanline256();
@@ -61,6 +65,7 @@ private:
         uint32_t *framebuffer = nullptr;
         uint32_t *hiRes3D = nullptr;
         bool top3D = false;
+        uint32_t inputTime = 0;
     };
 
     std::queue<Buffers> framebuffers;
@@ -72,6 +77,11 @@ private:
     std::thread *thread = nullptr;
 
     int frames = 0;
+    int skipFrames = 0;
+    bool lowRes3D = false;
+    double avgLoad = 0;
+    int loadCount = 0;
+
     bool gbaBlock = true;
     bool displayCapture = false;
     uint8_t dirty3D = 0;
@@ -85,6 +95,8 @@ private:
     static uint32_t rgb6ToRgb8(uint32_t color);
     static uint16_t rgb6ToRgb5(uint32_t color);
 
+    int getFrameskip();
+
     void drawGbaThreaded();
     void drawThreaded();
 };
@@ -388,7 +388,7 @@ void Gpu3D::runCommands() {
 
 void Gpu3D::processVertices() {
     // Scale the viewport based on the high-res 3D setting
-    bool resShift = Settings::highRes3D;
+    bool resShift = core->gpu.isHighRes3D();
     uint16_t x = viewport[0] << resShift;
     uint16_t y = viewport[1] << resShift;
     uint16_t w = viewport[2] << resShift;
@@ -107,7 +107,10 @@ uint32_t *Gpu3DRenderer::getLine1(int line) {
     }
 
     // Wait until a scanline is ready, and then return it
-    while (ready[line].load() < 3) std::this_thread::yield();
+    if (ready[line].load() < 3) {
+        WaitTimer timer(core->frameStats, PHASE_3D);
+        while (ready[line].load() < 3) std::this_thread::yield();
+    }
     return &framebuffer[0][line * 256 * 2];
 }
 
@@ -130,7 +133,7 @@ void Gpu3DRenderer::drawScanline(int line) {
         }
 
         // Update the resolution shift for the next frame
-        resShift = Settings::highRes3D;
+        resShift = core->gpu.isHighRes3D();
 
         // Clean up any existing threads
         for (size_t i = 0; i < threads.size(); i++) {
@@ -174,6 +177,8 @@ void Gpu3DRenderer::drawThreaded(int thread) {
     // Draw the 3D scanlines in a threaded sequence
     // The amount of scanlines skipped per thread depends on the number of active threads
     // Together, they render the entire 3D image
+    Trace::nameThread("GPU 3D");
+    TraceScope scope("drawThreaded3D");
     int i, end = 192 << resShift;
     for (i = thread; i < end; i += activeThreads) {
         switch (ready[i].exchange(1)) {
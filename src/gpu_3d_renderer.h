@@ -39,6 +39,7 @@ public:
     void drawScanline(int line);
     uint32_t *getLine(int line);
 
+    int getThreadCount() { return activeThreads; }
     uint16_t readDisp3DCnt() { return disp3DCnt; }
 
     void writeDisp3DCnt(uint16_t mask, uint16_t value);
@@ -17,30 +17,108 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <chrono>
+
 #include "core.h"
 
+uint32_t Input::timestamp() {
+    // Get the current host time in microseconds, truncated to 32 bits for packing
+    // Only differences between timestamps are used, so wrapping around is fine
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Input::publish(uint32_t clear, uint32_t set) {
+    // Atomically update the published key bits and stamp them with the current time
+    // This is lock-free so the frontend never stalls the core, and vice versa
+    uint64_t value = published.load();
+    uint64_t update;
+    do {
+        uint32_t keys = ((uint32_t)value & ~clear) | set;
+        if (keys == (uint32_t)value) return;
+        update = ((uint64_t)timestamp() << 32) | keys;
+    }
+    while (!published.compare_exchange_weak(value, update));
+}
+
+void Input::latch() {
+    // Sample the freshest published input
+    uint64_t value = published.load();
+    uint16_t keys = value, extKeys = value >> 16;
+
+    // Remember when the input changed so its latency to the display can be measured
+    if (keys != keyInput || extKeys != extKeyIn)
+        changeTime = value >> 32;
+    keyInput = keys;
+    extKeyIn = extKeys;
+
+    // Hold the input for the rest of the frame if latching is enabled
+    // This samples as late as possible, at the first read of the frame, to minimize latency
+    latched = Settings::inputLatch;
+}
+
+void Input::nextFrame() {
+    // Latch input for frames where the guest didn't read it, and release it for the next frame
+    if (!latched) latch();
+    latched = false;
+}
+
+void Input::hold(uint32_t keys) {
+    // Override input for the rest of the frame, ignoring what the frontend publishes
+    keyInput = keys;
+    extKeyIn = keys >> 16;
+    latched = true;
+}
+
+uint32_t Input::takeChangeTime() {
+    // Get the time of the last input change not yet shown in a frame, and clear it
+    uint32_t time = changeTime;
+    changeTime = 0;
+    return time;
+}
+
+void Input::reportLatency(uint32_t changeTime) {
+    // Accumulate the time from an input change to display of the frame it affected
+    // This is called from the frontend thread when a frame is presented
+    int latency = timestamp() - changeTime;
+    latencySum += latency;
+    latencyPeak = std::max(latencyPeak, latency);
+    latencyCount++;
+
+    // Update the latency statistics and reset the counters every second
+    uint32_t now = timestamp();
+    if (now - lastStatTime >= 1000000) {
+        latencyAvg = latencySum / std::max(latencyCount, 1);
+        latencyMax = latencyPeak;
+        LOG_INFO("Input latency: %dus average, %dus max over %d changes\n", latencyAvg, latencyMax, latencyCount);
+        latencySum = latencyPeak = latencyCount = 0;
+        lastStatTime = now;
+    }
+}
+
 void Input::pressKey(int key) {
     // Clear key bits to indicate presses
     if (key < 10) // A, B, select, start, right, left, up, down, R, L
-        keyInput &= ~BIT(key);
+        publish(BIT(key), 0);
     else if (key < 12) // X, Y
-        extKeyIn &= ~BIT(key - 10);
+        publish(BIT(key - 10 + 16), 0);
 }
 
 void Input::releaseKey(int key) {
     // Set key bits to indicate releases
     if (key < 10) // A, B, select, start, right, left, up, down, R, L
-        keyInput |= BIT(key);
+        publish(0, BIT(key));
     else if (key < 12) // X, Y
-        extKeyIn |= BIT(key - 10);
+        publish(0, BIT(key - 10 + 16));
 }
 
 void Input::pressScreen() {
     // Clear the pen down bit to indicate a touch press
-    extKeyIn &= ~BIT(6);
+    publish(BIT(6 + 16), 0);
 }
 
 void Input::releaseScreen() {
     // Set the pen down bit to indicate a touch release
-    extKeyIn |= BIT(6);
+    publish(0, BIT(6 + 16));
 }
@@ -19,12 +19,16 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 
 class Core;
 
 class Input {
 public:
+    int latencyAvg = 0;
+    int latencyMax = 0;
+
     Input(Core *core): core(core) {}
 
     void pressKey(int key);
@@ -32,12 +36,32 @@ public:
     void pressScreen();
     void releaseScreen();
 
-    uint16_t readKeyInput() { return keyInput; }
-    uint16_t readExtKeyIn() { return extKeyIn; }
+    void nextFrame();
+    void hold(uint32_t keys);
+    uint32_t getKeys() { return published.load(); }
+    uint32_t takeChangeTime();
+    void reportLatency(uint32_t changeTime);
+
+    uint16_t readKeyInput() { if (!latched) latch(); return keyInput; }
+    uint16_t readExtKeyIn() { if (!latched) latch(); return extKeyIn; }
 
 private:
     Core *core;
 
+    // Input published by the frontend, with key bits in the low word and a change timestamp in the high word
+    std::atomic<uint64_t> published { 0x007F03FF };
+
     uint16_t keyInput = 0x03FF;
     uint16_t extKeyIn = 0x007F;
+    bool latched = false;
+    uint32_t changeTime = 0;
+
+    int64_t latencySum = 0;
+    int latencyPeak = 0;
+    int latencyCount = 0;
+    uint32_t lastStatTime = 0;
+
+    static uint32_t timestamp();
+    void publish(uint32_t clear, uint32_t set);
+    void latch();
 };
@@ -34,6 +34,7 @@ void Interpreter::saveState(FILE *file) {
     fwrite(registersAbt, 4, sizeof(registersAbt) / 4, file);
     fwrite(registersIrq, 4, sizeof(registersIrq) / 4, file);
     fwrite(registersUnd, 4, sizeof(registersUnd) / 4, file);
+    flushFlags();
     fwrite(&cpsr, sizeof(cpsr), 1, file);
     fwrite(&spsrFiq, sizeof(spsrFiq), 1, file);
     fwrite(&spsrSvc, sizeof(spsrSvc), 1, file);
@@ -72,9 +73,10 @@ void Interpreter::loadState(FILE *file) {
     fread(&irf, sizeof(irf), 1, file);
     fread(&postFlg, sizeof(postFlg), 1, file);
 
-    // Update mapped registers
+    // Update mapped registers and use the loaded flags
     swapRegisters(cpsr);
     pcData = nullptr;
+    flagMode = FLAGS_NONE;
 }
 
 void Interpreter::init() {
@@ -162,6 +164,89 @@ void Interpreter::runCoreNds(Core &core) {
     }
 }
 
+void Interpreter::runCoreNdsQuantum(Core &core) {
+    // Run the core with both CPUs active in NDS mode, switching between them less often
+    Interpreter &arm9 = core.interpreter[0];
+    Interpreter &arm7 = core.interpreter[1];
+    while (core.running.exchange(true)) {
+        while (core.events[0].cycles > core.globalCycles) {
+            // Start a newly unhalted CPU at the current cycle
+            arm9.cycles = std::max(arm9.cycles, core.globalCycles);
+            arm7.cycles = std::max(arm7.cycles, core.globalCycles);
+            core.cpuSync = false;
+
+            // Run whichever CPU is behind until it's a quantum ahead of the other one
+            // It stops early at the next scheduled task, or if it touches state shared with the other CPU
+            // The global cycle count follows the running CPU, so anything it schedules is timed relative to it
+            // The ARM9 goes first on ties like in exact interleaving, so a quantum of 1 is equivalent to it
+            if (arm9.cycles <= arm7.cycles) {
+                uint64_t end = std::min<uint64_t>(core.events[0].cycles, uint64_t(arm7.cycles) + Settings::cpuQuantum);
+                core.globalCycles = arm9.cycles;
+                while (core.globalCycles < end && core.events[0].cycles > core.globalCycles && !core.cpuSync)
+                    arm9.cycles = (core.globalCycles += arm9.runOpcode());
+            }
+            else {
+                uint64_t end = std::min<uint64_t>(core.events[0].cycles, uint64_t(arm9.cycles) + Settings::cpuQuantum - 1);
+                core.globalCycles = arm7.cycles;
+                while (core.globalCycles < end && core.events[0].cycles > core.globalCycles && !core.cpuSync)
+                    arm7.cycles = (core.globalCycles += arm7.runOpcode() << 1);
+            }
+
+            // Fall back to the CPU that's behind, so tasks are never passed by both
+            core.globalCycles = std::min<uint32_t>(arm9.cycles, arm7.cycles);
+        }
+
+        // Jump to the next task and run all that are scheduled now
+        core.globalCycles = core.events[0].cycles;
+        while (core.events[0].cycles <= core.globalCycles) {
+            core.tasks[core.events[0].task]();
+            core.events.erase(core.events.begin());
+        }
+    }
+}
+
+void Interpreter::runCoreNdsThreaded(Core &core) {
+    // Run the core with both CPUs active in NDS mode, with the ARM7 on its own thread
+    Interpreter &arm9 = core.interpreter[0];
+    Interpreter &arm7 = core.interpreter[1];
+    while (core.running.exchange(true)) {
+        if (core.events[0].cycles > core.globalCycles) {
+            // Start a newly unhalted CPU at the current cycle
+            arm9.cycles = std::max(arm9.cycles, core.globalCycles);
+            arm7.cycles = std::max(arm7.cycles, core.globalCycles);
+
+            // Run the ARM9 on this thread and the ARM7 on the other until the next scheduled task
+            core.arm7Thread.startWindow();
+            runThreaded<false>(core);
+            core.arm7Thread.finishWindow();
+        }
+
+        // Jump to the next task and run all that are scheduled now
+        // Both CPUs are stopped here, so tasks don't need to synchronize
+        core.globalCycles = core.events[0].cycles;
+        while (core.events[0].cycles <= core.globalCycles) {
+            core.tasks[core.events[0].task]();
+            core.events.erase(core.events.begin());
+        }
+    }
+
+    // Let the ARM7 thread sleep until it's needed again
+    core.arm7Thread.endSession();
+}
+
+template void Interpreter::runThreaded<false>(Core &core);
+template void Interpreter::runThreaded<true>(Core &core);
+template <bool _arm7> void Interpreter::runThreaded(Core &core) {
+    // Run one CPU in parallel with the other until the next scheduled task, publishing its progress
+    // The ARM7 runs at half speed, so its cycles count double
+    Interpreter &arm = core.interpreter[_arm7];
+    while (core.arm7Thread.canRun(_arm7, arm.cycles)) {
+        uint32_t cycles = arm.cycles;
+        arm.cycles = cycles + (arm.runOpcode() << _arm7);
+        core.arm7Thread.publish(_arm7, arm.cycles);
+    }
+}
+
 void Interpreter::runCoreDsi(Core &core) {
     // Run the core in DSi mode
     Interpreter &arm9 = core.interpreter[0];
@@ -202,17 +287,28 @@ FORCE_INLINE int Interpreter::runOpcode() {
         pipeline[1] = (((*registers[15] += 2) & 0xFFE) && pcData) ? U8TO16(pcData += 2, 0) : getOpcode16();
 
         // Execute a THUMB instruction
+#ifdef DIRECT_DISPATCH
+        return (*thumbInstrs[(opcode >> 6) & 0x3FF])(*this, opcode);
+#else
         return (this->*thumbInstrs[(opcode >> 6) & 0x3FF])(opcode);
+#endif
     }
     else { // ARM mode
         // Increment the program counter and fill the pipeline from pointer or fallback
         pipeline[1] = (((*registers[15] += 4) & 0xFFC) && pcData) ? U8TO32(pcData += 4, 0) : getOpcode32();
 
         // Execute an ARM instruction based on its condition
+        // Deferred flags only need to be settled if the condition isn't always true
+        if (opcode < 0xE0000000) flushFlags();
         switch (condition[((opcode >> 24) & 0xF0) | (cpsr >> 28)]) {
             case 0: return 1; // False
             case 2: return handleReserved(opcode); // Reserved
-            default: return (this->*armInstrs[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0xF)])(opcode);
+            default:
+#ifdef DIRECT_DISPATCH
+                return (*armInstrs[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0xF)])(*this, opcode);
+#else
+                return (this->*armInstrs[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0xF)])(opcode);
+#endif
         }
     }
 }
@@ -252,8 +348,9 @@ void Interpreter::unhalt(int bit) {
 }
 
 void Interpreter::sendInterrupt(int bit) {
-    // Set the interrupt's request bit
+    // Set the interrupt's request bit, and end the current CPU quantum so the IRQ isn't delayed by it
     irf |= BIT(bit);
+    core->cpuSync = true;
 
     // Trigger an interrupt if the conditions are met, or unhalt the CPU even if interrupts are disabled
     // The ARM9 additionally needs IME to be set for it to unhalt, but the ARM7 doesn't care
@@ -274,6 +371,12 @@ void Interpreter::interrupt() {
 }
 
 int Interpreter::exception(uint8_t vector) {
+    // HLE BIOS functions can touch anything, so they count as a shared access for the threaded ARM7
+    Arm7Lock lock(core->arm7Thread);
+
+    // Settle deferred flags so they're seen by the exception handler and saved to the SPSR
+    flushFlags();
+
     // Forward the call to HLE BIOS if enabled, unless on ARM9 with the exception address changed
     if (bios && (arm7 || core->cp15.exceptionAddr))
         return bios->execute(vector, registers);
@@ -287,15 +390,55 @@ int Interpreter::exception(uint8_t vector) {
     return 3;
 }
 
+void Interpreter::clearJumpCache() {
+    // Forget all cached jump target pages, for when the memory map changes
+    for (int i = 0; i < 0x40; i++)
+        jumpCache[i] = JumpEntry();
+}
+
+void Interpreter::takeJumpStats(uint32_t &lookups, uint32_t &misses) {
+    // Get the jump cache counts since the last call, and reset them
+    lookups = jumpLookups;
+    misses = jumpMisses;
+    jumpLookups = jumpMisses = 0;
+}
+
+FORCE_INLINE uint8_t *Interpreter::getJumpData(uint32_t address) {
+    // Get the opcode pointer for a jump target's page, caching it to avoid a lookup in the large memory map
+    uint32_t page = address >> 12;
+    // Lookups are only counted when requested, since this is a hot path
+    JumpEntry &entry = jumpCache[page & 0x3F];
+    if (jumpStats) jumpLookups++;
+    if (entry.page != page) {
+        if (jumpStats) jumpMisses++;
+        entry.page = page;
+        entry.data = (arm7 ? core->memory.readMap7 : core->memory.readMap9A)[page];
+    }
+    return entry.data;
+}
+
 void Interpreter::flushPipeline() {
     // Adjust the program counter and refill the pipeline after a jump
+    // If both opcodes are in the same mapped page, they can be loaded directly
     if (cpsr & BIT(5)) { // THUMB mode
         *registers[15] = (*registers[15] & ~0x1) + 2;
+        if ((*registers[15] & 0xFFE) && (pcData = getJumpData(*registers[15]))) {
+            pcData += (*registers[15] & 0xFFE);
+            pipeline[0] = U8TO16(pcData, -2);
+            pipeline[1] = U8TO16(pcData, 0);
+            return;
+        }
         pipeline[0] = core->memory.read<uint16_t>(arm7, *registers[15] - 2);
         pipeline[1] = getOpcode16();
     }
     else { // ARM mode
         *registers[15] = (*registers[15] & ~0x3) + 4;
+        if ((*registers[15] & 0xFFC) && (pcData = getJumpData(*registers[15]))) {
+            pcData += (*registers[15] & 0xFFC);
+            pipeline[0] = U8TO32(pcData, -4);
+            pipeline[1] = U8TO32(pcData, 0);
+            return;
+        }
         pipeline[0] = core->memory.read<uint32_t>(arm7, *registers[15] - 4);
         pipeline[1] = getOpcode32();
     }
@@ -377,7 +520,31 @@ void Interpreter::swapRegisters(uint32_t value) {
     }
 }
 
+void Interpreter::settleFlags() {
+    // Write deferred flags to the CPSR based on the last flag-setting operation
+    uint32_t nz = (flagRes & BIT(31)) | ((flagRes == 0) << 30);
+    switch (flagMode) {
+    case FLAGS_NZ:
+        cpsr = (cpsr & ~0xC0000000) | nz;
+        break;
+
+    case FLAGS_ADD:
+        cpsr = (cpsr & ~0xF0000000) | nz | ((flagOp1 > flagRes) << 29) |
+            ((~(flagOp2 ^ flagOp1) & (flagRes ^ flagOp2) & BIT(31)) >> 3);
+        break;
+
+    case FLAGS_SUB:
+        cpsr = (cpsr & ~0xF0000000) | nz | ((flagOp1 >= flagRes) << 29) |
+            (((flagOp2 ^ flagOp1) & ~(flagRes ^ flagOp2) & BIT(31)) >> 3);
+        break;
+    }
+    flagMode = FLAGS_NONE;
+}
+
 void Interpreter::setCpsr(uint32_t value, bool save) {
+    // Settle deferred flags so the old value is complete, since the new one replaces them
+    flushFlags();
+
     // Update registers if the CPU mode changed
     if ((value & 0x1F) != (cpsr & 0x1F))
         swapRegisters(value);
@@ -387,11 +554,16 @@ void Interpreter::setCpsr(uint32_t value, bool save) {
     cpsr = value;
 
     // Trigger an interrupt if the conditions are met
-    if (ime && (ie & irf) && !(cpsr & BIT(7)))
+    if (ime && (ie & irf) && !(cpsr & BIT(7))) {
+        Arm7Lock lock(core->arm7Thread);
         core->schedule(SchedTask(ARM9_INTERRUPT + arm7), (arm7 && !core->gbaMode) + 1);
+    }
 }
 
 int Interpreter::handleReserved(uint32_t opcode) {
+    // HLE returns and DLDI functions count as a shared access for the threaded ARM7
+    Arm7Lock lock(core->arm7Thread);
+
     // The ARM9-exclusive BLX instruction uses the reserved condition code, so let it run
     if ((opcode & 0xE000000) == 0xA000000)
         return blx(opcode); // BLX label
@@ -420,6 +592,7 @@ int Interpreter::handleReserved(uint32_t opcode) {
 
 int Interpreter::handleHleIrq() {
     // Switch to IRQ mode, save the return address, and push registers to the stack
+    flushFlags();
     setCpsr((cpsr & ~0x3F) | BIT(7) | 0x12, true);
     *registers[14] = *registers[15] + ((*spsr & BIT(5)) ? 2 : 0);
     stmdbW((13 << 16) | BIT(0) | BIT(1) | BIT(2) | BIT(3) | BIT(12) | BIT(14));
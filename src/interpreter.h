@@ -25,6 +25,13 @@
 class Core;
 class HleBios;
 
+enum FlagMode {
+    FLAGS_NONE, // All flags are in the CPSR
+    FLAGS_NZ, // N and Z come from the last result, C and V are in the CPSR
+    FLAGS_ADD, // All flags come from the last addition
+    FLAGS_SUB // All flags come from the last subtraction
+};
+
 class Interpreter {
 public:
     HleBios *bios = nullptr;
@@ -42,10 +49,16 @@ public:
     static void runCoreNone(Core &core);
     template <bool, int> static void runCoreSingle(Core &core);
     static void runCoreNds(Core &core);
+    static void runCoreNdsQuantum(Core &core);
+    static void runCoreNdsThreaded(Core &core);
+    template <bool> static void runThreaded(Core &core);
     static void runCoreDsi(Core &core);
 
     uint16_t getOpcode16();
     uint32_t getOpcode32();
+    void clearJumpCache();
+    void takeJumpStats(uint32_t &lookups, uint32_t &misses);
+    void setJumpStats(bool enabled) { jumpStats = enabled; }
 
     void halt(int bit);
     void unhalt(int bit);
@@ -53,7 +66,9 @@ public:
     void interrupt();
 
     bool isThumb() { return cpsr & BIT(5); }
+    uint8_t getMode() { return cpsr & 0x1F; }
     uint32_t getPC() { return *registers[15]; }
+    uint32_t getCycles() { return cycles; }
     int handleHleIrq();
 
     uint8_t readIme() { return ime; }
@@ -67,11 +82,20 @@ public:
     void writePostFlg(uint8_t value);
 
 private:
+    struct JumpEntry {
+        uint32_t page = 0xFFFFFFFF;
+        uint8_t *data = nullptr;
+    };
+
     Core *core;
     bool arm7;
 
     uint8_t *pcData = nullptr;
     uint32_t pipeline[2] = {};
+    JumpEntry jumpCache[0x40];
+    uint32_t jumpLookups = 0;
+    uint32_t jumpMisses = 0;
+    bool jumpStats = false;
 
     uint32_t *registers[32] = {};
     uint32_t registersUsr[16] = {};
@@ -84,6 +108,9 @@ private:
     uint32_t cpsr = 0, *spsr = nullptr;
     uint32_t spsrFiq = 0, spsrSvc = 0, spsrAbt = 0, spsrIrq = 0, spsrUnd = 0;
 
+    uint8_t flagMode = FLAGS_NONE;
+    uint32_t flagRes = 0, flagOp1 = 0, flagOp2 = 0;
+
     uint32_t cycles = 0;
     bool dsiCycle = false;
 
@@ -91,18 +118,46 @@ private:
     uint32_t ie = 0, irf = 0;
     uint8_t postFlg = 0;
 
-    static int (Interpreter::*armInstrs[0x1000])(uint32_t);
-    static int (Interpreter::*thumbInstrs[0x400])(uint16_t);
+#ifdef DIRECT_DISPATCH
+    typedef int (*ArmInstr)(Interpreter&, uint32_t);
+    typedef int (*ThumbInstr)(Interpreter&, uint16_t);
+#else
+    typedef int (Interpreter::*ArmInstr)(uint32_t);
+    typedef int (Interpreter::*ThumbInstr)(uint16_t);
+#endif
+
+    static ArmInstr armInstrs[0x1000];
+    static ThumbInstr thumbInstrs[0x400];
 
     static const uint8_t condition[0x100];
     static const uint8_t bitCount[0x100];
 
+    template <int (Interpreter::*func)(uint32_t)> static int dispatch(Interpreter &cpu, uint32_t opcode);
+    template <int (Interpreter::*func)(uint16_t)> static int dispatch(Interpreter &cpu, uint16_t opcode);
+
+    void setNZ(uint32_t res);
+    void setAddFlags(uint32_t op1, uint32_t op2, uint32_t res);
+    void setSubFlags(uint32_t op1, uint32_t op2, uint32_t res);
+    void flushFlags() { if (flagMode != FLAGS_NONE) settleFlags(); }
+    void flushCarry() { if (flagMode > FLAGS_NZ) settleFlags(); }
+    uint32_t getCarry() { flushCarry(); return (cpsr >> 29) & 0x1; }
+    void settleFlags();
+
+    bool canFuse(int cycles);
+    bool checkSub(int cond, uint32_t op1, uint32_t op2, uint32_t res);
+    int fuseBranch(uint32_t op1, uint32_t op2, uint32_t res);
+    int fuseBranchT(uint32_t op1, uint32_t op2, uint32_t res);
+    int fuseBlT();
+
     int runOpcode();
     int exception(uint8_t vector);
+    uint8_t *getJumpData(uint32_t address);
     void flushPipeline();
     void swapRegisters(uint32_t value);
     void setCpsr(uint32_t value, bool save = false);
     int handleReserved(uint32_t opcode);
+    void loadBlock(uint32_t **regs, uint16_t list, uint32_t address, uint8_t m);
+    void storeBlock(uint32_t **regs, uint16_t list, uint32_t address, uint8_t m);
     int finishHleIrq();
 
     int unkArm(uint32_t opcode);
@@ -826,3 +881,26 @@ private:
     int blxOffT(uint16_t opcode);
     int swiT(uint16_t opcode);
 };
+
+FORCE_INLINE void Interpreter::setNZ(uint32_t res) {
+    // Defer the N and Z flags until they're read, settling C and V first if they were also deferred
+    if (flagMode > FLAGS_NZ) settleFlags();
+    flagMode = FLAGS_NZ;
+    flagRes = res;
+}
+
+FORCE_INLINE void Interpreter::setAddFlags(uint32_t op1, uint32_t op2, uint32_t res) {
+    // Defer all flags from an addition until they're read
+    flagMode = FLAGS_ADD;
+    flagOp1 = op1;
+    flagOp2 = op2;
+    flagRes = res;
+}
+
+FORCE_INLINE void Interpreter::setSubFlags(uint32_t op1, uint32_t op2, uint32_t res) {
+    // Defer all flags from a subtraction until they're read
+    flagMode = FLAGS_SUB;
+    flagOp1 = op1;
+    flagOp2 = op2;
+    flagRes = res;
+}
@@ -126,7 +126,7 @@ FORCE_INLINE uint32_t Interpreter::rri(uint32_t opcode) { // Rm,ROR #i
     // A shift of 0 translates to a rotate with carry of 1
     uint32_t value = *registers[opcode & 0xF];
     uint8_t shift = (opcode >> 7) & 0x1F;
-    return shift ? ((value << (32 - shift)) | (value >> shift)) : (((cpsr & BIT(29)) << 2) | (value >> 1));
+    return shift ? ((value << (32 - shift)) | (value >> shift)) : ((getCarry() << 31) | (value >> 1));
 }
 
 FORCE_INLINE uint32_t Interpreter::rrr(uint32_t opcode) { // Rm,ROR Rs
@@ -146,6 +146,7 @@ FORCE_INLINE uint32_t Interpreter::imm(uint32_t opcode) { // #i
 
 FORCE_INLINE uint32_t Interpreter::lliS(uint32_t opcode) { // Rm,LSL #i (S)
     // Logical shift left by immediate and set carry flag
+    flushCarry();
     uint32_t value = *registers[opcode & 0xF];
     uint8_t shift = (opcode >> 7) & 0x1F;
     if (shift > 0) cpsr = (cpsr & ~BIT(29)) | ((bool)(value & BIT(32 - shift)) << 29);
@@ -155,6 +156,7 @@ FORCE_INLINE uint32_t Interpreter::lliS(uint32_t opcode) { // Rm,LSL #i (S)
 FORCE_INLINE uint32_t Interpreter::llrS(uint32_t opcode) { // Rm,LSL Rs (S)
     // Logical shift left by register and set carry flag
     // When used as Rm, the program counter is read with +4
+    flushCarry();
     uint32_t value = *registers[opcode & 0xF] + (((opcode & 0xF) == 0xF) << 2);
     uint8_t shift = *registers[(opcode >> 8) & 0xF];
     if (shift > 0) cpsr = (cpsr & ~BIT(29)) | ((shift <= 32 && (value & BIT(32 - shift))) << 29);
@@ -164,6 +166,7 @@ FORCE_INLINE uint32_t Interpreter::llrS(uint32_t opcode) { // Rm,LSL Rs (S)
 FORCE_INLINE uint32_t Interpreter::lriS(uint32_t opcode) { // Rm,LSR #i (S)
     // Logical shift right by immediate and set carry flag
     // A shift of 0 translates to a shift of 32
+    flushCarry();
     uint32_t value = *registers[opcode & 0xF];
     uint8_t shift = (opcode >> 7) & 0x1F;
     cpsr = (cpsr & ~BIT(29)) | ((bool)(value & BIT(shift ? (shift - 1) : 31)) << 29);
@@ -173,6 +176,7 @@ FORCE_INLINE uint32_t Interpreter::lriS(uint32_t opcode) { // Rm,LSR #i (S)
 FORCE_INLINE uint32_t Interpreter::lrrS(uint32_t opcode) { // Rm,LSR Rs (S)
     // Logical shift right by register and set carry flag
     // When used as Rm, the program counter is read with +4
+    flushCarry();
     uint32_t value = *registers[opcode & 0xF] + (((opcode & 0xF) == 0xF) << 2);
     uint8_t shift = *registers[(opcode >> 8) & 0xF];
     if (shift > 0) cpsr = (cpsr & ~BIT(29)) | ((shift <= 32 && (value & BIT(shift - 1))) << 29);
@@ -182,6 +186,7 @@ FORCE_INLINE uint32_t Interpreter::lrrS(uint32_t opcode) { // Rm,LSR Rs (S)
 FORCE_INLINE uint32_t Interpreter::ariS(uint32_t opcode) { // Rm,ASR #i (S)
     // Arithmetic shift right by immediate and set carry flag
     // A shift of 0 translates to a shift of 32
+    flushCarry();
     int32_t value = *registers[opcode & 0xF];
     uint8_t shift = (opcode >> 7) & 0x1F;
     cpsr = (cpsr & ~BIT(29)) | ((bool)(value & BIT(shift ? (shift - 1) : 31)) << 29);
@@ -191,6 +196,7 @@ FORCE_INLINE uint32_t Interpreter::ariS(uint32_t opcode) { // Rm,ASR #i (S)
 FORCE_INLINE uint32_t Interpreter::arrS(uint32_t opcode) { // Rm,ASR Rs (S)
     // Arithmetic shift right by register and set carry flag
     // When used as Rm, the program counter is read with +4
+    flushCarry();
     int32_t value = *registers[opcode & 0xF] + (((opcode & 0xF) == 0xF) << 2);
     uint8_t shift = *registers[(opcode >> 8) & 0xF];
     if (shift > 0) cpsr = (cpsr & ~BIT(29)) | ((bool)(value & BIT((shift <= 32) ? (shift - 1) : 31)) << 29);
@@ -200,6 +206,7 @@ FORCE_INLINE uint32_t Interpreter::arrS(uint32_t opcode) { // Rm,ASR Rs (S)
 FORCE_INLINE uint32_t Interpreter::rriS(uint32_t opcode) { // Rm,ROR #i (S)
     // Rotate right by immediate and set carry flag
     // A shift of 0 translates to a rotate with carry of 1
+    flushCarry();
     uint32_t value = *registers[opcode & 0xF];
     uint8_t shift = (opcode >> 7) & 0x1F;
     uint32_t res = shift ? ((value << (32 - shift)) | (value >> shift)) : (((cpsr & BIT(29)) << 2) | (value >> 1));
@@ -210,6 +217,7 @@ FORCE_INLINE uint32_t Interpreter::rriS(uint32_t opcode) { // Rm,ROR #i (S)
 FORCE_INLINE uint32_t Interpreter::rrrS(uint32_t opcode) { // Rm,ROR Rs (S)
     // Rotate right by register and set carry flag
     // When used as Rm, the program counter is read with +4
+    flushCarry();
     uint32_t value = *registers[opcode & 0xF] + (((opcode & 0xF) == 0xF) << 2);
     uint8_t shift = *registers[(opcode >> 8) & 0xF];
     if (shift > 0) cpsr = (cpsr & ~BIT(29)) | ((bool)(value & BIT((shift - 1) & 0x1F)) << 29);
@@ -218,6 +226,7 @@ FORCE_INLINE uint32_t Interpreter::rrrS(uint32_t opcode) { // Rm,ROR Rs (S)
 
 FORCE_INLINE uint32_t Interpreter::immS(uint32_t opcode) { // #i (S)
     // Rotate 8-bit immediate right by a multiple of 2 and set carry flag
+    flushCarry();
     uint32_t value = opcode & 0xFF;
     uint8_t shift = (opcode >> 7) & 0x1E;
     if (shift > 0) cpsr = (cpsr & ~BIT(29)) | ((bool)(value & BIT(shift - 1)) << 29);
@@ -294,7 +303,7 @@ FORCE_INLINE int Interpreter::adc(uint32_t opcode, uint32_t op2) { // ADC Rd,Rn,
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
-    *op0 = op1 + op2 + ((cpsr & BIT(29)) >> 29);
+    *op0 = op1 + op2 + getCarry();
 
     // Handle pipelining
     if (op0 != registers[15]) return 1;
@@ -307,7 +316,7 @@ FORCE_INLINE int Interpreter::sbc(uint32_t opcode, uint32_t op2) { // SBC Rd,Rn,
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
-    *op0 = op1 - op2 - 1 + ((cpsr & BIT(29)) >> 29);
+    *op0 = op1 - op2 - 1 + getCarry();
 
     // Handle pipelining
     if (op0 != registers[15]) return 1;
@@ -320,7 +329,7 @@ FORCE_INLINE int Interpreter::rsc(uint32_t opcode, uint32_t op2) { // RSC Rd,Rn,
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
-    *op0 = op2 - op1 - 1 + ((cpsr & BIT(29)) >> 29);
+    *op0 = op2 - op1 - 1 + getCarry();
 
     // Handle pipelining
     if (op0 != registers[15]) return 1;
@@ -333,7 +342,7 @@ FORCE_INLINE int Interpreter::tst(uint32_t opcode, uint32_t op2) { // TST Rn,op2
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     uint32_t res = op1 & op2;
-    cpsr = (cpsr & ~0xC0000000) | (res & BIT(31)) | ((res == 0) << 30);
+    setNZ(res);
     return 1;
 }
 
@@ -342,7 +351,7 @@ FORCE_INLINE int Interpreter::teq(uint32_t opcode, uint32_t op2) { // TEQ Rn,op2
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     uint32_t res = op1 ^ op2;
-    cpsr = (cpsr & ~0xC0000000) | (res & BIT(31)) | ((res == 0) << 30);
+    setNZ(res);
     return 1;
 }
 
@@ -351,9 +360,11 @@ FORCE_INLINE int Interpreter::cmp(uint32_t opcode, uint32_t op2) { // CMP Rn,op2
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     uint32_t res = op1 - op2;
-    cpsr = (cpsr & ~0xF0000000) | (res & BIT(31)) | ((res == 0) << 30) |
-        ((op1 >= res) << 29) | (((op2 ^ op1) & ~(res ^ op2) & BIT(31)) >> 3);
-    return 1;
+    setSubFlags(op1, op2, res);
+
+    // Run a following conditional branch along with the compare, unless shifting by register
+    if ((opcode & 0x2000010) == 0x0000010) return 1;
+    return fuseBranch(op1, op2, res);
 }
 
 FORCE_INLINE int Interpreter::cmn(uint32_t opcode, uint32_t op2) { // CMN Rn,op2
@@ -361,8 +372,7 @@ FORCE_INLINE int Interpreter::cmn(uint32_t opcode, uint32_t op2) { // CMN Rn,op2
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     uint32_t res = op1 + op2;
-    cpsr = (cpsr & ~0xF0000000) | (res & BIT(31)) | ((res == 0) << 30) |
-        ((op1 > res) << 29) | ((~(op2 ^ op1) & (res ^ op2) & BIT(31)) >> 3);
+    setAddFlags(op1, op2, res);
     return 1;
 }
 
@@ -420,7 +430,7 @@ FORCE_INLINE int Interpreter::ands(uint32_t opcode, uint32_t op2) { // ANDS Rd,R
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     *op0 = op1 & op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
 
     // Handle pipelining and mode switching
     if (op0 != registers[15]) return 1;
@@ -435,7 +445,7 @@ FORCE_INLINE int Interpreter::eors(uint32_t opcode, uint32_t op2) { // EORS Rd,R
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     *op0 = op1 ^ op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
 
     // Handle pipelining and mode switching
     if (op0 != registers[15]) return 1;
@@ -450,8 +460,7 @@ FORCE_INLINE int Interpreter::subs(uint32_t opcode, uint32_t op2) { // SUBS Rd,R
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     *op0 = op1 - op2;
-    cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((op1 >= *op0) << 29) | (((op2 ^ op1) & ~(*op0 ^ op2) & BIT(31)) >> 3);
+    setSubFlags(op1, op2, *op0);
 
     // Handle pipelining and mode switching
     if (op0 != registers[15]) return 1;
@@ -466,8 +475,7 @@ FORCE_INLINE int Interpreter::rsbs(uint32_t opcode, uint32_t op2) { // RSBS Rd,R
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     *op0 = op2 - op1;
-    cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((op2 >= *op0) << 29) | (((op1 ^ op2) & ~(*op0 ^ op1) & BIT(31)) >> 3);
+    setSubFlags(op2, op1, *op0);
 
     // Handle pipelining and mode switching
     if (op0 != registers[15]) return 1;
@@ -482,8 +490,7 @@ FORCE_INLINE int Interpreter::adds(uint32_t opcode, uint32_t op2) { // ADDS Rd,R
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     *op0 = op1 + op2;
-    cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((op1 > *op0) << 29) | ((~(op2 ^ op1) & (*op0 ^ op2) & BIT(31)) >> 3);
+    setAddFlags(op1, op2, *op0);
 
     // Handle pipelining and mode switching
     if (op0 != registers[15]) return 1;
@@ -497,6 +504,7 @@ FORCE_INLINE int Interpreter::adcs(uint32_t opcode, uint32_t op2) { // ADCS Rd,R
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
+    flushFlags();
     *op0 = op1 + op2 + ((cpsr & BIT(29)) >> 29);
     cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) | ((op1 > *op0 ||
         (op2 == -1 && (cpsr & BIT(29)))) << 29) | ((~(op2 ^ op1) & (*op0 ^ op2) & BIT(31)) >> 3);
@@ -513,6 +521,7 @@ FORCE_INLINE int Interpreter::sbcs(uint32_t opcode, uint32_t op2) { // SBCS Rd,R
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
+    flushFlags();
     *op0 = op1 - op2 - 1 + ((cpsr & BIT(29)) >> 29);
     cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) | ((op1 >= *op0 &&
         (op2 != -1 || (cpsr & BIT(29)))) << 29) | (((op2 ^ op1) & ~(*op0 ^ op2) & BIT(31)) >> 3);
@@ -529,6 +538,7 @@ FORCE_INLINE int Interpreter::rscs(uint32_t opcode, uint32_t op2) { // RSCS Rd,R
     // When used as Rn when shifting by register, the program counter is read with +4
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
+    flushFlags();
     *op0 = op2 - op1 - 1 + ((cpsr & BIT(29)) >> 29);
     cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) | ((op2 >= *op0 &&
         (op1 != -1 || (cpsr & BIT(29)))) << 29) | (((op1 ^ op2) & ~(*op0 ^ op1) & BIT(31)) >> 3);
@@ -546,7 +556,7 @@ FORCE_INLINE int Interpreter::orrs(uint32_t opcode, uint32_t op2) { // ORRS Rd,R
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     *op0 = op1 | op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
 
     // Handle pipelining and mode switching
     if (op0 != registers[15]) return 1;
@@ -559,7 +569,7 @@ FORCE_INLINE int Interpreter::movs(uint32_t opcode, uint32_t op2) { // MOVS Rd,o
     // Move and set flags
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     *op0 = op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
 
     // Handle pipelining and mode switching
     if (op0 != registers[15]) return 1;
@@ -574,7 +584,7 @@ FORCE_INLINE int Interpreter::bics(uint32_t opcode, uint32_t op2) { // BICS Rd,R
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     uint32_t op1 = *registers[(opcode >> 16) & 0xF] + (((opcode & 0x20F0010) == 0x00F0010) << 2);
     *op0 = op1 & ~op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
 
     // Handle pipelining and mode switching
     if (op0 != registers[15]) return 1;
@@ -587,7 +597,7 @@ FORCE_INLINE int Interpreter::mvns(uint32_t opcode, uint32_t op2) { // MVNS Rd,o
     // Move negative and set flags
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
     *op0 = ~op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
 
     // Handle pipelining and mode switching
     if (op0 != registers[15]) return 1;
@@ -691,7 +701,7 @@ int Interpreter::muls(uint32_t opcode) { // MULS Rd,Rm,Rs
     uint32_t op1 = *registers[opcode & 0xF];
     int32_t op2 = *registers[(opcode >> 8) & 0xF];
     *op0 = op1 * op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
 
     // Calculate timing
     if (!arm7) return 4;
@@ -706,7 +716,7 @@ int Interpreter::mlas(uint32_t opcode) { // MLAS Rd,Rm,Rs,Rn
     int32_t op2 = *registers[(opcode >> 8) & 0xF];
     uint32_t op3 = *registers[(opcode >> 12) & 0xF];
     *op0 = op1 * op2 + op3;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
 
     // Calculate timing
     if (!arm7) return 4;
@@ -722,6 +732,7 @@ int Interpreter::umulls(uint32_t opcode) { // UMULLS RdLo,RdHi,Rm,Rs
     uint32_t op3 = *registers[(opcode >> 8) & 0xF];
     uint64_t res = uint64_t(op2) * op3;
     *op0 = res, *op1 = res >> 32;
+    flushFlags();
     cpsr = (cpsr & ~0xC0000000) | (*op1 & BIT(31)) | ((res == 0) << 30);
 
     // Calculate timing
@@ -739,6 +750,7 @@ int Interpreter::umlals(uint32_t opcode) { // UMLALS RdLo,RdHi,Rm,Rs
     uint64_t res = uint64_t(op2) * op3;
     res += (uint64_t(*op1) << 32) | *op0;
     *op0 = res, *op1 = res >> 32;
+    flushFlags();
     cpsr = (cpsr & ~0xC0000000) | (*op1 & BIT(31)) | ((res == 0) << 30);
 
     // Calculate timing
@@ -755,6 +767,7 @@ int Interpreter::smulls(uint32_t opcode) { // SMULLS RdLo,RdHi,Rm,Rs
     int32_t op3 = *registers[(opcode >> 8) & 0xF];
     int64_t res = int64_t(op2) * op3;
     *op0 = res, *op1 = res >> 32;
+    flushFlags();
     cpsr = (cpsr & ~0xC0000000) | (*op1 & BIT(31)) | ((res == 0) << 30);
 
     // Calculate timing
@@ -772,6 +785,7 @@ int Interpreter::smlals(uint32_t opcode) { // SMLALS RdLo,RdHi,Rm,Rs
     int64_t res = int64_t(op2) * op3;
     res += (int64_t(*op1) << 32) | *op0;
     *op0 = res, *op1 = res >> 32;
+    flushFlags();
     cpsr = (cpsr & ~0xC0000000) | (*op1 & BIT(31)) | ((res == 0) << 30);
 
     // Calculate timing
@@ -1019,8 +1033,7 @@ int Interpreter::addRegT(uint16_t opcode) { // ADD Rd,Rs,Rn
     uint32_t op1 = *registers[(opcode >> 3) & 0x7];
     uint32_t op2 = *registers[(opcode >> 6) & 0x7];
     *op0 = op1 + op2;
-    cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((op1 > *op0) << 29) | ((~(op2 ^ op1) & (*op0 ^ op2) & BIT(31)) >> 3);
+    setAddFlags(op1, op2, *op0);
     return 1;
 }
 
@@ -1030,8 +1043,7 @@ int Interpreter::subRegT(uint16_t opcode) { // SUB Rd,Rs,Rn
     uint32_t op1 = *registers[(opcode >> 3) & 0x7];
     uint32_t op2 = *registers[(opcode >> 6) & 0x7];
     *op0 = op1 - op2;
-    cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((op1 >= *op0) << 29) | (((op2 ^ op1) & ~(*op0 ^ op2) & BIT(31)) >> 3);
+    setSubFlags(op1, op2, *op0);
     return 1;
 }
 
@@ -1052,9 +1064,8 @@ int Interpreter::cmpHT(uint16_t opcode) { // CMP Rd,Rs
     uint32_t op1 = *registers[((opcode >> 4) & 0x8) | (opcode & 0x7)];
     uint32_t op2 = *registers[(opcode >> 3) & 0xF];
     uint32_t res = op1 - op2;
-    cpsr = (cpsr & ~0xF0000000) | (res & BIT(31)) | ((res == 0) << 30) |
-        ((op1 >= res) << 29) | (((op2 ^ op1) & ~(res ^ op2) & BIT(31)) >> 3);
-    return 1;
+    setSubFlags(op1, op2, res);
+    return fuseBranchT(op1, op2, res);
 }
 
 int Interpreter::movHT(uint16_t opcode) { // MOV Rd,Rs
@@ -1101,7 +1112,7 @@ int Interpreter::lslImmT(uint16_t opcode) { // LSL Rd,Rs,#i
     uint32_t op1 = *registers[(opcode >> 3) & 0x7];
     uint8_t op2 = (opcode >> 6) & 0x1F;
     *op0 = op1 << op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     if (op2 > 0) cpsr = (cpsr & ~BIT(29)) | ((bool)(op1 & BIT(32 - op2)) << 29);
     return 1;
 }
@@ -1113,8 +1124,8 @@ int Interpreter::lsrImmT(uint16_t opcode) { // LSR Rd,Rs,#i
     uint32_t op1 = *registers[(opcode >> 3) & 0x7];
     uint8_t op2 = (opcode >> 6) & 0x1F;
     *op0 = op2 ? (op1 >> op2) : 0;
-    cpsr = (cpsr & ~0xE0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((bool)(op1 & BIT(op2 ? (op2 - 1) : 31)) << 29);
+    setNZ(*op0);
+    cpsr = (cpsr & ~BIT(29)) | ((bool)(op1 & BIT(op2 ? (op2 - 1) : 31)) << 29);
     return 1;
 }
 
@@ -1125,8 +1136,8 @@ int Interpreter::asrImmT(uint16_t opcode) { // ASR Rd,Rs,#i
     uint32_t op1 = *registers[(opcode >> 3) & 0x7];
     uint8_t op2 = (opcode >> 6) & 0x1F;
     *op0 = op2 ? ((int32_t)op1 >> op2) : ((op1 & BIT(31)) ? -1 : 0);
-    cpsr = (cpsr & ~0xE0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((bool)(op1 & BIT(op2 ? (op2 - 1) : 31)) << 29);
+    setNZ(*op0);
+    cpsr = (cpsr & ~BIT(29)) | ((bool)(op1 & BIT(op2 ? (op2 - 1) : 31)) << 29);
     return 1;
 }
 
@@ -1136,8 +1147,7 @@ int Interpreter::addImm3T(uint16_t opcode) { // ADD Rd,Rs,#i
     uint32_t op1 = *registers[(opcode >> 3) & 0x7];
     uint32_t op2 = (opcode >> 6) & 0x7;
     *op0 = op1 + op2;
-    cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((op1 > *op0) << 29) | ((~(op2 ^ op1) & (*op0 ^ op2) & BIT(31)) >> 3);
+    setAddFlags(op1, op2, *op0);
     return 1;
 }
 
@@ -1147,8 +1157,7 @@ int Interpreter::subImm3T(uint16_t opcode) { // SUB Rd,Rs,#i
     uint32_t op1 = *registers[(opcode >> 3) & 0x7];
     uint32_t op2 = (opcode >> 6) & 0x7;
     *op0 = op1 - op2;
-    cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((op1 >= *op0) << 29) | (((op2 ^ op1) & ~(*op0 ^ op2) & BIT(31)) >> 3);
+    setSubFlags(op1, op2, *op0);
     return 1;
 }
 
@@ -1158,8 +1167,7 @@ int Interpreter::addImm8T(uint16_t opcode) { // ADD Rd,#i
     uint32_t op1 = *registers[(opcode >> 8) & 0x7];
     uint32_t op2 = opcode & 0xFF;
     *op0 += op2;
-    cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((op1 > *op0) << 29) | ((~(op2 ^ op1) & (*op0 ^ op2) & BIT(31)) >> 3);
+    setAddFlags(op1, op2, *op0);
     return 1;
 }
 
@@ -1169,8 +1177,7 @@ int Interpreter::subImm8T(uint16_t opcode) { // SUB Rd,#i
     uint32_t op1 = *registers[(opcode >> 8) & 0x7];
     uint32_t op2 = opcode & 0xFF;
     *op0 -= op2;
-    cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) |
-        ((op1 >= *op0) << 29) | (((op2 ^ op1) & ~(*op0 ^ op2) & BIT(31)) >> 3);
+    setSubFlags(op1, op2, *op0);
     return 1;
 }
 
@@ -1179,9 +1186,8 @@ int Interpreter::cmpImm8T(uint16_t opcode) { // CMP Rd,#i
     uint32_t op1 = *registers[(opcode >> 8) & 0x7];
     uint32_t op2 = opcode & 0xFF;
     uint32_t res = op1 - op2;
-    cpsr = (cpsr & ~0xF0000000) | (res & BIT(31)) | ((res == 0) << 30) |
-        ((op1 >= res) << 29) | (((op2 ^ op1) & ~(res ^ op2) & BIT(31)) >> 3);
-    return 1;
+    setSubFlags(op1, op2, res);
+    return fuseBranchT(op1, op2, res);
 }
 
 int Interpreter::movImm8T(uint16_t opcode) { // MOV Rd,#i
@@ -1189,7 +1195,7 @@ int Interpreter::movImm8T(uint16_t opcode) { // MOV Rd,#i
     uint32_t *op0 = registers[(opcode >> 8) & 0x7];
     uint32_t op2 = opcode & 0xFF;
     *op0 = op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     return 1;
 }
 
@@ -1199,7 +1205,7 @@ int Interpreter::lslDpT(uint16_t opcode) { // LSL Rd,Rs
     uint32_t op1 = *registers[opcode & 0x7];
     uint8_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 = (op2 < 32) ? (*op0 << op2) : 0;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     if (op2 > 0) cpsr = (cpsr & ~BIT(29)) | ((op2 <= 32 && (op1 & BIT(32 - op2))) << 29);
     return 1;
 }
@@ -1210,7 +1216,7 @@ int Interpreter::lsrDpT(uint16_t opcode) { // LSR Rd,Rs
     uint32_t op1 = *registers[opcode & 0x7];
     uint8_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 = (op2 < 32) ? (*op0 >> op2) : 0;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     if (op2 > 0) cpsr = (cpsr & ~BIT(29)) | ((op2 <= 32 && (op1 & BIT(op2 - 1))) << 29);
     return 1;
 }
@@ -1221,7 +1227,7 @@ int Interpreter::asrDpT(uint16_t opcode) { // ASR Rd,Rs
     uint32_t op1 = *registers[opcode & 0x7];
     uint8_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 = (op2 < 32) ? ((int32_t)(*op0) >> op2) : ((*op0 & BIT(31)) ? -1 : 0);
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     if (op2 > 0) cpsr = (cpsr & ~BIT(29)) | ((bool)(op1 & BIT((op2 <= 32) ? (op2 - 1) : 31)) << 29);
     return 1;
 }
@@ -1232,7 +1238,7 @@ int Interpreter::rorDpT(uint16_t opcode) { // ROR Rd,Rs
     uint32_t op1 = *registers[opcode & 0x7];
     uint8_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 = (*op0 << (32 - (op2 & 0x1F))) | (*op0 >> (op2 & 0x1F));
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     if (op2 > 0) cpsr = (cpsr & ~BIT(29)) | ((bool)(op1 & BIT((op2 - 1) & 0x1F)) << 29);
     return 1;
 }
@@ -1242,7 +1248,7 @@ int Interpreter::andDpT(uint16_t opcode) { // AND Rd,Rs
     uint32_t *op0 = registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 &= op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     return 1;
 }
 
@@ -1251,7 +1257,7 @@ int Interpreter::eorDpT(uint16_t opcode) { // EOR Rd,Rs
     uint32_t *op0 = registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 ^= op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     return 1;
 }
 
@@ -1260,6 +1266,7 @@ int Interpreter::adcDpT(uint16_t opcode) { // ADC Rd,Rs
     uint32_t *op0 = registers[opcode & 0x7];
     uint32_t op1 = *registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
+    flushFlags();
     *op0 += op2 + ((cpsr & BIT(29)) >> 29);
     cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) | ((op1 > *op0 ||
         (op2 == -1 && (cpsr & BIT(29)))) << 29) | ((~(op2 ^ op1) & (*op0 ^ op2) & BIT(31)) >> 3);
@@ -1271,6 +1278,7 @@ int Interpreter::sbcDpT(uint16_t opcode) { // SBC Rd,Rs
     uint32_t *op0 = registers[opcode & 0x7];
     uint32_t op1 = *registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
+    flushFlags();
     *op0 = op1 - op2 - 1 + ((cpsr & BIT(29)) >> 29);
     cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) | ((op1 >= *op0 &&
         (op2 != -1 || (cpsr & BIT(29)))) << 29) | (((op2 ^ op1) & ~(*op0 ^ op2) & BIT(31)) >> 3);
@@ -1282,7 +1290,7 @@ int Interpreter::tstDpT(uint16_t opcode) { // TST Rd,Rs
     uint32_t op1 = *registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
     uint32_t res = op1 & op2;
-    cpsr = (cpsr & ~0xC0000000) | (res & BIT(31)) | ((res == 0) << 30);
+    setNZ(res);
     return 1;
 }
 
@@ -1291,9 +1299,8 @@ int Interpreter::cmpDpT(uint16_t opcode) { // CMP Rd,Rs
     uint32_t op1 = *registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
     uint32_t res = op1 - op2;
-    cpsr = (cpsr & ~0xF0000000) | (res & BIT(31)) | ((res == 0) << 30) |
-        ((op1 >= res) << 29) | (((op2 ^ op1) & ~(res ^ op2) & BIT(31)) >> 3);
-    return 1;
+    setSubFlags(op1, op2, res);
+    return fuseBranchT(op1, op2, res);
 }
 
 int Interpreter::cmnDpT(uint16_t opcode) { // CMN Rd,Rs
@@ -1301,8 +1308,7 @@ int Interpreter::cmnDpT(uint16_t opcode) { // CMN Rd,Rs
     uint32_t op1 = *registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
     uint32_t res = op1 + op2;
-    cpsr = (cpsr & ~0xF0000000) | (res & BIT(31)) | ((res == 0) << 30) |
-        ((op1 > res) << 29) | ((~(op2 ^ op1) & (res ^ op2) & BIT(31)) >> 3);
+    setAddFlags(op1, op2, res);
     return 1;
 }
 
@@ -1311,7 +1317,7 @@ int Interpreter::orrDpT(uint16_t opcode) { // ORR Rd,Rs
     uint32_t *op0 = registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 |= op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     return 1;
 }
 
@@ -1320,7 +1326,7 @@ int Interpreter::bicDpT(uint16_t opcode) { // BIC Rd,Rs
     uint32_t *op0 = registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 &= ~op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     return 1;
 }
 
@@ -1329,7 +1335,7 @@ int Interpreter::mvnDpT(uint16_t opcode) { // MVN Rd,Rs
     uint32_t *op0 = registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 = ~op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
     return 1;
 }
 
@@ -1338,6 +1344,7 @@ int Interpreter::negDpT(uint16_t opcode) { // NEG Rd,Rs
     uint32_t *op0 = registers[opcode & 0x7];
     uint32_t op2 = *registers[(opcode >> 3) & 0x7];
     *op0 = -op2;
+    flushFlags();
     cpsr = (cpsr & ~0xF0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30) | ((*op0 <= 0) << 29);
     return 1;
 }
@@ -1348,7 +1355,7 @@ int Interpreter::mulDpT(uint16_t opcode) { // MUL Rd,Rs
     uint32_t op1 = *registers[(opcode >> 3) & 0x7];
     int32_t op2 = *registers[opcode & 0x7];
     *op0 = op1 * op2;
-    cpsr = (cpsr & ~0xC0000000) | (*op0 & BIT(31)) | ((*op0 == 0) << 30);
+    setNZ(*op0);
 
     // Calculate timing
     if (!arm7) return 4;
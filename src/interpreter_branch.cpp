@@ -97,6 +97,7 @@ int Interpreter::blxRegT(uint16_t opcode) { // BLX Rs
 int Interpreter::beqT(uint16_t opcode) { // BEQ label
     // Branch to offset if equal (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (~cpsr & BIT(30)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -106,6 +107,7 @@ int Interpreter::beqT(uint16_t opcode) { // BEQ label
 int Interpreter::bneT(uint16_t opcode) { // BNE label
     // Branch to offset if not equal (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (cpsr & BIT(30)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -115,6 +117,7 @@ int Interpreter::bneT(uint16_t opcode) { // BNE label
 int Interpreter::bcsT(uint16_t opcode) { // BCS label
     // Branch to offset if carry set (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (~cpsr & BIT(29)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -124,6 +127,7 @@ int Interpreter::bcsT(uint16_t opcode) { // BCS label
 int Interpreter::bccT(uint16_t opcode) { // BCC label
     // Branch to offset if carry clear (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (cpsr & BIT(29)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -133,6 +137,7 @@ int Interpreter::bccT(uint16_t opcode) { // BCC label
 int Interpreter::bmiT(uint16_t opcode) { // BMI label
     // Branch to offset if negative (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (~cpsr & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -142,6 +147,7 @@ int Interpreter::bmiT(uint16_t opcode) { // BMI label
 int Interpreter::bplT(uint16_t opcode) { // BPL label
     // Branch to offset if positive (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (cpsr & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -151,6 +157,7 @@ int Interpreter::bplT(uint16_t opcode) { // BPL label
 int Interpreter::bvsT(uint16_t opcode) { // BVS label
     // Branch to offset if overflow set (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (~cpsr & BIT(28)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -160,6 +167,7 @@ int Interpreter::bvsT(uint16_t opcode) { // BVS label
 int Interpreter::bvcT(uint16_t opcode) { // BVC label
     // Branch to offset if overflow clear (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (cpsr & BIT(28)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -169,6 +177,7 @@ int Interpreter::bvcT(uint16_t opcode) { // BVC label
 int Interpreter::bhiT(uint16_t opcode) { // BHI label
     // Branch to offset if higher (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if ((cpsr & 0x60000000) != 0x20000000) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -178,6 +187,7 @@ int Interpreter::bhiT(uint16_t opcode) { // BHI label
 int Interpreter::blsT(uint16_t opcode) { // BLS label
     // Branch to offset if lower or same (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if ((cpsr & 0x60000000) == 0x20000000) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -187,6 +197,7 @@ int Interpreter::blsT(uint16_t opcode) { // BLS label
 int Interpreter::bgeT(uint16_t opcode) { // BGE label
     // Branch to offset if signed greater or equal (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if ((cpsr ^ (cpsr << 3)) & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -196,6 +207,7 @@ int Interpreter::bgeT(uint16_t opcode) { // BGE label
 int Interpreter::bltT(uint16_t opcode) { // BLT label
     // Branch to offset if signed less than (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (~(cpsr ^ (cpsr << 3)) & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -205,6 +217,7 @@ int Interpreter::bltT(uint16_t opcode) { // BLT label
 int Interpreter::bgtT(uint16_t opcode) { // BGT label
     // Branch to offset if signed greater than (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (((cpsr ^ (cpsr << 3)) | (cpsr << 1)) & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -214,6 +227,7 @@ int Interpreter::bgtT(uint16_t opcode) { // BGT label
 int Interpreter::bleT(uint16_t opcode) { // BLE label
     // Branch to offset if signed less or equal (THUMB)
     int32_t op0 = (int8_t)opcode << 1;
+    flushFlags();
     if (~((cpsr ^ (cpsr << 3)) | (cpsr << 1)) & BIT(31)) return 1;
     *registers[15] += op0;
     flushPipeline();
@@ -232,7 +246,7 @@ int Interpreter::blSetupT(uint16_t opcode) { // BL/BLX label
     // Set the upper 11 bits of the target address for a long BL/BLX (THUMB)
     int32_t op0 = (int16_t)(opcode << 5) >> 4;
     *registers[14] = *registers[15] + (op0 << 11);
-    return 1;
+    return fuseBlT();
 }
 
 int Interpreter::blOffT(uint16_t opcode) { // BL label
@@ -263,3 +277,76 @@ int Interpreter::swiT(uint16_t opcode) { // SWI #i
     *registers[15] -= 4;
     return exception(0x08);
 }
+
+FORCE_INLINE bool Interpreter::canFuse(int cycles) {
+    // Check if the next opcode would run right after the current one with nothing in between
+    // A scheduled task like an interrupt, halt, or DMA code write breaks a pair, as does the other CPU running first
+    // ARM9 cycles are counted as ARM7 cycles to be safe, and the threaded ARM7 doesn't fuse at all
+    if (core->arm7Thread.enabled) return false;
+    uint32_t end = std::max(this->cycles, core->globalCycles) + (cycles << 1);
+    return core->events[0].cycles > end && (core->gbaMode || core->interpreter[!arm7].cycles > end);
+}
+
+bool Interpreter::checkSub(int cond, uint32_t op1, uint32_t op2, uint32_t res) {
+    // Check a condition directly from the operands of a compare
+    switch (cond) {
+    case 0x0: return op1 == op2; // EQ
+    case 0x1: return op1 != op2; // NE
+    case 0x2: return op1 >= op2; // CS
+    case 0x3: return op1 < op2; // CC
+    case 0x4: return res & BIT(31); // MI
+    case 0x5: return !(res & BIT(31)); // PL
+    case 0x6: return (op2 ^ op1) & ~(res ^ op2) & BIT(31); // VS
+    case 0x7: return !((op2 ^ op1) & ~(res ^ op2) & BIT(31)); // VC
+    case 0x8: return op1 > op2; // HI
+    case 0x9: return op1 <= op2; // LS
+    case 0xA: return int32_t(op1) >= int32_t(op2); // GE
+    case 0xB: return int32_t(op1) < int32_t(op2); // LT
+    case 0xC: return int32_t(op1) > int32_t(op2); // GT
+    case 0xD: return int32_t(op1) <= int32_t(op2); // LE
+    default: return true; // AL
+    }
+}
+
+int Interpreter::fuseBranch(uint32_t op1, uint32_t op2, uint32_t res) {
+    // Check for a conditional branch right after a compare
+    uint32_t opcode = pipeline[0];
+    if ((opcode & 0x0F000000) != 0x0A000000 || opcode >= 0xE0000000 || !canFuse(1)) return 1;
+
+    // Push the branch through the pipeline as if it ran on its own
+    pipeline[0] = pipeline[1];
+    pipeline[1] = (((*registers[15] += 4) & 0xFFC) && pcData) ? U8TO32(pcData += 4, 0) : getOpcode32();
+
+    // Take the branch based on the compare operands, so the deferred flags don't need to be settled
+    if (!checkSub(opcode >> 28, op1, op2, res)) return 2;
+    *registers[15] += (int32_t)(opcode << 8) >> 6;
+    flushPipeline();
+    return 4;
+}
+
+int Interpreter::fuseBranchT(uint32_t op1, uint32_t op2, uint32_t res) {
+    // Check for a conditional branch right after a compare (THUMB)
+    uint32_t opcode = pipeline[0];
+    if ((opcode & 0xF000) != 0xD000 || (opcode & 0xE00) == 0xE00 || !canFuse(1)) return 1;
+
+    // Push the branch through the pipeline as if it ran on its own
+    pipeline[0] = pipeline[1];
+    pipeline[1] = (((*registers[15] += 2) & 0xFFE) && pcData) ? U8TO16(pcData += 2, 0) : getOpcode16();
+
+    // Take the branch based on the compare operands, so the deferred flags don't need to be settled
+    if (!checkSub((opcode >> 8) & 0xF, op1, op2, res)) return 2;
+    *registers[15] += (int8_t)opcode << 1;
+    flushPipeline();
+    return 4;
+}
+
+int Interpreter::fuseBlT() {
+    // Check for the second half of a long BL/BLX right after the first (THUMB)
+    uint32_t opcode = pipeline[0];
+    if ((opcode & 0xE800) != 0xE800 || !canFuse(1)) return 1;
+
+    // Push the second half through the pipeline and run it as if it ran on its own
+    pipeline[0] = pipeline[1];
+    pipeline[1] = (((*registers[15] += 2) & 0xFFE) && pcData) ? U8TO16(pcData += 2, 0) : getOpcode16();
+    return 1 + ((opcode & BIT(12)) ? blOffT(opcode) : blxOffT(opcode));
+}
@@ -19,6 +19,50 @@
 
 #include "core.h"
 
+FORCE_INLINE void Interpreter::loadBlock(uint32_t **regs, uint16_t list, uint32_t address, uint8_t m) {
+    // Load a block of registers directly if the whole range lies within one mapped page
+    if ((address & 0xFFC) + (m << 2) <= 0x1000) {
+        if (uint8_t *data = (arm7 ? core->memory.readMap7 : core->memory.readMap9A)[address >> 12]) {
+            data += address & 0xFFC;
+            for (int i = 0; i < 16; i++) {
+                if (~list & BIT(i)) continue;
+                *regs[i] = U8TO32(data, 0);
+                data += 4;
+            }
+            return;
+        }
+    }
+
+    // Fall back to loading each register on its own
+    for (int i = 0; i < 16; i++) {
+        if (~list & BIT(i)) continue;
+        *regs[i] = core->memory.read<uint32_t>(arm7, address);
+        address += 4;
+    }
+}
+
+FORCE_INLINE void Interpreter::storeBlock(uint32_t **regs, uint16_t list, uint32_t address, uint8_t m) {
+    // Store a block of registers directly if the whole range lies within one mapped page
+    if ((address & 0xFFC) + (m << 2) <= 0x1000) {
+        if (uint8_t *data = (arm7 ? core->memory.writeMap7 : core->memory.writeMap9A)[address >> 12]) {
+            data += address & 0xFFC;
+            for (int i = 0; i < 16; i++) {
+                if (~list & BIT(i)) continue;
+                U32TO8(data, 0, *regs[i]);
+                data += 4;
+            }
+            return;
+        }
+    }
+
+    // Fall back to storing each register on its own
+    for (int i = 0; i < 16; i++) {
+        if (~list & BIT(i)) continue;
+        core->memory.write<uint32_t>(arm7, address, *regs[i]);
+        address += 4;
+    }
+}
+
 // Define functions for each ARM offset variation (half type)
 #define HALF_FUNCS(func) \
     int Interpreter::func##Ofrm(uint32_t opcode) { return func##Of(opcode, -rp(opcode)); } \
@@ -124,7 +168,7 @@ FORCE_INLINE uint32_t Interpreter::rprr(uint32_t opcode) { // Rm,ROR #i
     // A shift of 0 translates to a1 rotate with carry of 1
     uint32_t value = *registers[opcode & 0xF];
     uint8_t shift = (opcode >> 7) & 0x1F;
-    return shift ? ((value << (32 - shift)) | (value >> shift)) : (((cpsr & BIT(29)) << 2) | (value >> 1));
+    return shift ? ((value << (32 - shift)) | (value >> shift)) : ((getCarry() << 31) | (value >> 1));
 }
 
 FORCE_INLINE int Interpreter::ldrsbOf(uint32_t opcode, uint32_t op2) { // LDRSB Rd,[Rn,op2]
@@ -539,10 +583,7 @@ int Interpreter::ldmda(uint32_t opcode) { // LDMDA Rn, <Rlist>
     // Block load, post-decrement without writeback
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint32_t op0 = *registers[(opcode >> 16) & 0xF] - (m << 2);
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, op0 += 4);
-    }
+    loadBlock(registers, opcode, op0 + 4, m);
 
     // Handle pipelining and THUMB switching
     if (~opcode & BIT(15)) return m + (arm7 ? 2 : (m < 2));
@@ -555,10 +596,7 @@ int Interpreter::stmda(uint32_t opcode) { // STMDA Rn, <Rlist>
     // Block store, post-decrement without writeback
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint32_t op0 = *registers[(opcode >> 16) & 0xF] - (m << 2);
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, op0 += 4, *registers[i]);
-    }
+    storeBlock(registers, opcode, op0 + 4, m);
     return m + (arm7 || m < 2);
 }
 
@@ -566,11 +604,7 @@ int Interpreter::ldmia(uint32_t opcode) { // LDMIA Rn, <Rlist>
     // Block load, post-increment without writeback
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint32_t op0 = *registers[(opcode >> 16) & 0xF];
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, op0);
-        op0 += 4;
-    }
+    loadBlock(registers, opcode, op0, m);
 
     // Handle pipelining and THUMB switching
     if (~opcode & BIT(15)) return m + (arm7 ? 2 : (m < 2));
@@ -583,11 +617,7 @@ int Interpreter::stmia(uint32_t opcode) { // STMIA Rn, <Rlist>
     // Block store, post-increment without writeback
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint32_t op0 = *registers[(opcode >> 16) & 0xF];
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, op0, *registers[i]);
-        op0 += 4;
-    }
+    storeBlock(registers, opcode, op0, m);
     return m + (arm7 || m < 2);
 }
 
@@ -595,11 +625,7 @@ int Interpreter::ldmdb(uint32_t opcode) { // LDMDB Rn, <Rlist>
     // Block load, pre-decrement without writeback
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint32_t op0 = *registers[(opcode >> 16) & 0xF] - (m << 2);
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, op0);
-        op0 += 4;
-    }
+    loadBlock(registers, opcode, op0, m);
 
     // Handle pipelining and THUMB switching
     if (~opcode & BIT(15)) return m + (arm7 ? 2 : (m < 2));
@@ -612,11 +638,7 @@ int Interpreter::stmdb(uint32_t opcode) { // STMDB Rn, <Rlist>
     // Block store, pre-decrement without writeback
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint32_t op0 = *registers[(opcode >> 16) & 0xF] - (m << 2);
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, op0, *registers[i]);
-        op0 += 4;
-    }
+    storeBlock(registers, opcode, op0, m);
     return m + (arm7 || m < 2);
 }
 
@@ -624,10 +646,7 @@ int Interpreter::ldmib(uint32_t opcode) { // LDMIB Rn, <Rlist>
     // Block load, pre-increment without writeback
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint32_t op0 = *registers[(opcode >> 16) & 0xF];
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, op0 += 4);
-    }
+    loadBlock(registers, opcode, op0 + 4, m);
 
     // Handle pipelining and THUMB switching
     if (~opcode & BIT(15)) return m + (arm7 ? 2 : (m < 2));
@@ -640,10 +659,7 @@ int Interpreter::stmib(uint32_t opcode) { // STMIB Rn, <Rlist>
     // Block store, pre-increment without writeback
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint32_t op0 = *registers[(opcode >> 16) & 0xF];
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, op0 += 4, *registers[i]);
-    }
+    storeBlock(registers, opcode, op0 + 4, m);
     return m + (arm7 || m < 2);
 }
 
@@ -652,14 +668,11 @@ int Interpreter::ldmdaW(uint32_t opcode) { // LDMDA Rn!, <Rlist>
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint8_t op0 = (opcode >> 16) & 0xF;
     uint32_t address = (*registers[op0] -= (m << 2));
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, address += 4);
-    }
+    loadBlock(registers, opcode, address + 4, m);
 
     // Load the writeback value if it's not last or is the only listed register on ARM9
     if (!arm7 && ((opcode & 0xFFFF & ~(BIT(op0 + 1) - 1)) || (opcode & 0xFFFF) == BIT(op0)))
-        *registers[op0] = address - (m << 2);
+        *registers[op0] = address;
 
     // Handle pipelining and THUMB switching
     if (~opcode & BIT(15)) return m + (arm7 ? 2 : (m < 2));
@@ -677,11 +690,8 @@ int Interpreter::stmdaW(uint32_t opcode) { // STMDA Rn!, <Rlist>
         *registers[op0] = address;
 
     // Block store, post-decrement with writeback
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, address += 4, *registers[i]);
-    }
-    *registers[op0] = address - (m << 2);
+    storeBlock(registers, opcode, address + 4, m);
+    *registers[op0] = address;
     return m + (arm7 || m < 2);
 }
 
@@ -690,15 +700,11 @@ int Interpreter::ldmiaW(uint32_t opcode) { // LDMIA Rn!, <Rlist>
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint8_t op0 = (opcode >> 16) & 0xF;
     uint32_t address = (*registers[op0] += (m << 2)) - (m << 2);
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, address);
-        address += 4;
-    }
+    loadBlock(registers, opcode, address, m);
 
     // Load the writeback value if it's not last or is the only listed register on ARM9
     if (!arm7 && ((opcode & 0xFFFF & ~(BIT(op0 + 1) - 1)) || (opcode & 0xFFFF) == BIT(op0)))
-        *registers[op0] = address;
+        *registers[op0] = address + (m << 2);
 
     // Handle pipelining and THUMB switching
     if (~opcode & BIT(15)) return m + (arm7 ? 2 : (m < 2));
@@ -716,12 +722,8 @@ int Interpreter::stmiaW(uint32_t opcode) { // STMIA Rn!, <Rlist>
         *registers[op0] = address + (m << 2);
 
     // Block store, post-increment with writeback
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, address, *registers[i]);
-        address += 4;
-    }
-    *registers[op0] = address;
+    storeBlock(registers, opcode, address, m);
+    *registers[op0] = address + (m << 2);
     return m + (arm7 || m < 2);
 }
 
@@ -730,15 +732,11 @@ int Interpreter::ldmdbW(uint32_t opcode) { // LDMDB Rn!, <Rlist>
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint8_t op0 = (opcode >> 16) & 0xF;
     uint32_t address = (*registers[op0] -= (m << 2));
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, address);
-        address += 4;
-    }
+    loadBlock(registers, opcode, address, m);
 
     // Load the writeback value if it's not last or is the only listed register on ARM9
     if (!arm7 && ((opcode & 0xFFFF & ~(BIT(op0 + 1) - 1)) || (opcode & 0xFFFF) == BIT(op0)))
-        *registers[op0] = address - (m << 2);
+        *registers[op0] = address;
 
     // Handle pipelining and THUMB switching
     if (~opcode & BIT(15)) return m + (arm7 ? 2 : (m < 2));
@@ -756,12 +754,8 @@ int Interpreter::stmdbW(uint32_t opcode) { // STMDB Rn!, <Rlist>
         *registers[op0] = address;
 
     // Block store, pre-decrement with writeback
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, address, *registers[i]);
-        address += 4;
-    }
-    *registers[op0] = address - (m << 2);
+    storeBlock(registers, opcode, address, m);
+    *registers[op0] = address;
     return m + (arm7 || m < 2);
 }
 
@@ -770,14 +764,11 @@ int Interpreter::ldmibW(uint32_t opcode) { // LDMIB Rn!, <Rlist>
     uint8_t m = bitCount[opcode & 0xFF] + bitCount[(opcode >> 8) & 0xFF];
     uint8_t op0 = (opcode >> 16) & 0xF;
     uint32_t address = (*registers[op0] += (m << 2)) - (m << 2);
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, address += 4);
-    }
+    loadBlock(registers, opcode, address + 4, m);
 
     // Load the writeback value if it's not last or is the only listed register on ARM9
     if (!arm7 && ((opcode & 0xFFFF & ~(BIT(op0 + 1) - 1)) || (opcode & 0xFFFF) == BIT(op0)))
-        *registers[op0] = address;
+        *registers[op0] = address + (m << 2);
 
     // Handle pipelining and THUMB switching
     if (~opcode & BIT(15)) return m + (arm7 ? 2 : (m < 2));
@@ -795,11 +786,8 @@ int Interpreter::stmibW(uint32_t opcode) { // STMIB Rn!, <Rlist>
         *registers[op0] = address + (m << 2);
 
     // Block store, pre-increment with writeback
-    for (int i = 0; i < 16; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, address += 4, *registers[i]);
-    }
-    *registers[op0] = address;
+    storeBlock(registers, opcode, address + 4, m);
+    *registers[op0] = address + (m << 2);
     return m + (arm7 || m < 2);
 }
 
@@ -1090,6 +1078,7 @@ int Interpreter::stmibUW(uint32_t opcode) { // STMIB Rn!, <Rlist>^
 int Interpreter::msrRc(uint32_t opcode) { // MSR CPSR,Rm
     // Write the first 8 bits of the status flags, only changing the CPU mode when not in user mode
     uint32_t op1 = *registers[opcode & 0xF];
+    flushFlags();
     if (opcode & BIT(16)) {
         uint8_t mask = ((cpsr & 0x1F) == 0x10) ? 0xE0 : 0xFF;
         setCpsr((cpsr & ~mask) | (op1 & mask));
@@ -1121,6 +1110,7 @@ int Interpreter::msrIc(uint32_t opcode) { // MSR CPSR,#i
     uint32_t op1 = (value << (32 - shift)) | (value >> shift);
 
     // Write the first 8 bits of the status flags, only changing the CPU mode when not in user mode
+    flushFlags();
     if (opcode & BIT(16)) {
         uint8_t mask = ((cpsr & 0x1F) == 0x10) ? 0xE0 : 0xFF;
         setCpsr((cpsr & ~mask) | (op1 & mask));
@@ -1152,6 +1142,7 @@ int Interpreter::msrIs(uint32_t opcode) { // MSR SPSR,#i
 int Interpreter::mrsRc(uint32_t opcode) { // MRS Rd,CPSR
     // Copy the status flags to a register
     uint32_t *op0 = registers[(opcode >> 12) & 0xF];
+    flushFlags();
     *op0 = cpsr;
     return 2 - arm7;
 }
@@ -1181,6 +1172,7 @@ int Interpreter::mcr(uint32_t opcode) { // MCR Pn,<cpopc>,Rd,Cn,Cm,<cp>
     uint8_t op3 = (opcode >> 16) & 0xF;
     uint8_t op4 = opcode & 0xF;
     uint8_t op5 = (opcode >> 5) & 0x7;
+    Arm7Lock lock(core->arm7Thread);
     core->cp15.write(op3, op4, op5, op2);
     return 1;
 }
@@ -1379,11 +1371,7 @@ int Interpreter::ldmiaT(uint16_t opcode) { // LDMIA Rb!,<Rlist>
     uint8_t m = bitCount[opcode & 0xFF];
     uint32_t *op0 = registers[(opcode >> 8) & 0x7];
     uint32_t address = (*op0 += (m << 2)) - (m << 2);
-    for (int i = 0; i < 8; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, address);
-        address += 4;
-    }
+    loadBlock(registers, opcode & 0xFF, address, m);
     return m + (arm7 ? 2 : (m < 2));
 }
 
@@ -1396,23 +1384,16 @@ int Interpreter::stmiaT(uint16_t opcode) { // STMIA Rb!,<Rlist>
         *registers[op0] = address + (m << 2);
 
     // Block store, post-increment with writeback (THUMB)
-    for (int i = 0; i < 8; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, address, *registers[i]);
-        address += 4;
-    }
-    *registers[op0] = address;
+    storeBlock(registers, opcode & 0xFF, address, m);
+    *registers[op0] = address + (m << 2);
     return m + (arm7 || m < 2);
 }
 
 int Interpreter::popT(uint16_t opcode) { // POP <Rlist>
     // SP-relative block load, post-increment with writeback (THUMB)
     uint8_t m = bitCount[opcode & 0xFF];
-    for (int i = 0; i < 8; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, *registers[13]);
-        *registers[13] += 4;
-    }
+    loadBlock(registers, opcode & 0xFF, *registers[13], m);
+    *registers[13] += (m << 2);
     return m + (arm7 ? 2 : (m < 2));
 }
 
@@ -1420,42 +1401,26 @@ int Interpreter::pushT(uint16_t opcode) { // PUSH <Rlist>
     // SP-relative block store, pre-decrement with writeback (THUMB)
     uint8_t m = bitCount[opcode & 0xFF];
     uint32_t address = (*registers[13] -= (m << 2));
-    for (int i = 0; i < 8; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, address, *registers[i]);
-        address += 4;
-    }
+    storeBlock(registers, opcode & 0xFF, address, m);
     return m + (arm7 || m < 2);
 }
 
 int Interpreter::popPcT(uint16_t opcode) { // POP <Rlist>,PC
-    // SP-relative block load, post-increment with writeback (THUMB)
+    // SP-relative block load including the program counter, post-increment with writeback (THUMB)
     uint8_t m = bitCount[opcode & 0xFF] + 1;
-    for (int i = 0; i < 8; i++) {
-        if (~opcode & BIT(i)) continue;
-        *registers[i] = core->memory.read<uint32_t>(arm7, *registers[13]);
-        *registers[13] += 4;
-    }
+    loadBlock(registers, (opcode & 0xFF) | BIT(15), *registers[13], m);
+    *registers[13] += (m << 2);
 
-    // Load the program counter and handle pipelining
-    *registers[15] = core->memory.read<uint32_t>(arm7, *registers[13]);
-    *registers[13] += 4;
+    // Handle pipelining and THUMB switching
     cpsr &= ~((~(*registers[15]) & !arm7) << 5);
     flushPipeline();
     return m + 4;
 }
 
 int Interpreter::pushLrT(uint16_t opcode) { // PUSH <Rlist>,LR
-    // SP-relative block store, pre-decrement with writeback (THUMB)
+    // SP-relative block store including the link register, pre-decrement with writeback (THUMB)
     uint8_t m = bitCount[opcode & 0xFF] + 1;
     uint32_t address = (*registers[13] -= (m << 2));
-    for (int i = 0; i < 8; i++) {
-        if (~opcode & BIT(i)) continue;
-        core->memory.write<uint32_t>(arm7, address, *registers[i]);
-        address += 4;
-    }
-
-    // Store the link register
-    core->memory.write<uint32_t>(arm7, address, *registers[14]);
+    storeBlock(registers, (opcode & 0xFF) | BIT(14), address, m);
     return m + (arm7 || m < 2);
 }
@@ -52,8 +52,22 @@ void Ipc::loadState(FILE *file) {
     }
 }
 
+uint16_t Ipc::readIpcSync(bool arm7) {
+    // Read from one of the IPCSYNC registers, ending the CPU's quantum if interleaving loosely
+    // CPUs often poll this while waiting on each other, so the other one should get a chance to run
+    core->cpuSync = true;
+    return ipcSync[arm7];
+}
+
+uint16_t Ipc::readIpcFifoCnt(bool arm7) {
+    // Read from one of the IPCFIFOCNT registers, ending the CPU's quantum if interleaving loosely
+    core->cpuSync = true;
+    return ipcFifoCnt[arm7];
+}
+
 void Ipc::writeIpcSync(bool arm7, uint16_t mask, uint16_t value) {
     // Write to one of the IPCSYNC registers
+    core->cpuSync = true;
     mask &= 0x4F00;
     ipcSync[arm7] = (ipcSync[arm7] & ~mask) | (value & mask);
 
@@ -70,6 +84,9 @@ void Ipc::writeIpcSync(bool arm7, uint16_t mask, uint16_t value) {
 }
 
 void Ipc::writeIpcFifoCnt(bool arm7, uint16_t mask, uint16_t value) {
+    // End the CPU's quantum so the other one sees FIFO changes promptly
+    core->cpuSync = true;
+
     // Clear the FIFO if the clear bit is set
     if ((value & BIT(3)) && !fifos[arm7].empty()) {
         // Empty the FIFO
@@ -105,6 +122,9 @@ void Ipc::writeIpcFifoCnt(bool arm7, uint16_t mask, uint16_t value) {
 }
 
 void Ipc::writeIpcFifoSend(bool arm7, uint32_t mask, uint32_t value) {
+    // End the CPU's quantum so the other one can receive the word promptly
+    core->cpuSync = true;
+
     if (ipcFifoCnt[arm7] & BIT(15)) { // FIFO enabled
         if (fifos[arm7].size() < 16) { // FIFO not full
             // Push a word to the FIFO or override for HLE ARM7 if enabled
@@ -136,6 +156,9 @@ void Ipc::writeIpcFifoSend(bool arm7, uint32_t mask, uint32_t value) {
 }
 
 uint32_t Ipc::readIpcFifoRecv(bool arm7) {
+    // End the CPU's quantum so the other one sees the FIFO drain promptly
+    core->cpuSync = true;
+
     if (!fifos[!arm7].empty()) {
         // Receive a word from the FIFO
         ipcFifoRecv[arm7] = fifos[!arm7].front();
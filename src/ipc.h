@@ -31,8 +31,8 @@ public:
     void saveState(FILE *file);
     void loadState(FILE *file);
 
-    uint16_t readIpcSync(bool arm7) { return ipcSync[arm7]; }
-    uint16_t readIpcFifoCnt(bool arm7) { return ipcFifoCnt[arm7]; }
+    uint16_t readIpcSync(bool arm7);
+    uint16_t readIpcFifoCnt(bool arm7);
     uint32_t readIpcFifoRecv(bool arm7);
 
     void writeIpcSync(bool arm7, uint16_t mask, uint16_t value);
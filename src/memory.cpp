@@ -174,6 +174,27 @@ void Memory::copyBiosLogo(uint8_t *logo) {
         memcpy(&bios9[0x20], logo, 0x9C);
 }
 
+static uint64_t hashBlock(uint64_t hash, const uint8_t *data, size_t size) {
+    // Fold 64-bit words into an FNV-1a style hash; sizes are always multiples of 8
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t word;
+        memcpy(&word, &data[i], sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3;
+    }
+    return hash;
+}
+
+uint64_t Memory::hashRam() {
+    // Hash the RAM that guest state lives in, so emulation runs can be compared for divergence
+    // Only the first 4MB of main RAM exists outside of DSi mode, and GBA memory is a subset of these
+    uint64_t hash = 0xCBF29CE484222325;
+    hash = hashBlock(hash, ram, core->dsiMode ? 0x1000000 : 0x400000);
+    hash = hashBlock(hash, wram, sizeof(wram));
+    hash = hashBlock(hash, wram7, sizeof(wram7));
+    hash = hashBlock(hash, instrTcm, sizeof(instrTcm));
+    return hashBlock(hash, dataTcm, sizeof(dataTcm));
+}
+
 void Memory::updateMap9(uint32_t start, uint32_t end, bool tcm) {
     // Update the ARM9 read and write memory maps in the given range
     for (uint64_t address = start; address < end; address += 0x1000) {
@@ -244,8 +265,9 @@ void Memory::updateMap9(uint32_t start, uint32_t end, bool tcm) {
     if (!tcm)
         updateMap9(start, end, true);
 
-    // Update the ARM9 opcode pointer in case it was remapped
+    // Update the ARM9 opcode pointer and jump targets in case they were remapped
     core->interpreter[0].getOpcode16();
+    core->interpreter[0].clearJumpCache();
 }
 
 void Memory::updateMap7(uint32_t start, uint32_t end) {
@@ -328,8 +350,9 @@ void Memory::updateMap7(uint32_t start, uint32_t end) {
         }
     }
 
-    // Update the ARM7 opcode pointer in case it was remapped
+    // Update the ARM7 opcode pointer and jump targets in case they were remapped
     core->interpreter[1].getOpcode16();
+    core->interpreter[1].clearJumpCache();
 }
 
 void Memory::updateVram() {
@@ -606,6 +629,9 @@ void Memory::updateVram() {
 }
 
 template <typename T> T Memory::readFallback(bool arm7, uint32_t address) {
+    // Get exclusive access if the ARM7 is threaded, since special reads can have side effects
+    Arm7Lock lock(core->arm7Thread);
+
     // Align the address
     address &= ~(sizeof(T) - 1);
     uint8_t *data = nullptr;
@@ -718,6 +744,9 @@ template <typename T> T Memory::readFallback(bool arm7, uint32_t address) {
 }
 
 template <typename T> void Memory::writeFallback(bool arm7, uint32_t address, T value) {
+    // Get exclusive access if the ARM7 is threaded, since writes can affect the other CPU
+    Arm7Lock lock(core->arm7Thread);
+
     // Align the address
     address &= ~(sizeof(T) - 1);
     uint8_t *data = nullptr;
@@ -819,6 +848,10 @@ template <typename T> void Memory::writeFallback(bool arm7, uint32_t address, T
 }
 
 template <typename T> T Memory::ioRead9(uint32_t address) {
+    // Count the access if I/O profiling is enabled
+    if (Settings::ioProfiler)
+        core->profiler.countIo(0, 0, sizeof(T), address);
+
     // Read a value from one or more ARM9 I/O registers
     T value = 0;
     for (uint32_t i = 0; i < sizeof(T);) {
@@ -949,6 +982,7 @@ template <typename T> T Memory::ioRead9(uint32_t address) {
             // Handle unknown reads by returning nothing
             if (i == 0) {
                 LOG_WARN("Unknown ARM9 I/O register read: 0x%X\n", address);
+                core->profiler.countUnknownIo(0, 0, address);
                 return 0;
             }
 
@@ -965,6 +999,10 @@ template <typename T> T Memory::ioRead9(uint32_t address) {
 }
 
 template <typename T> T Memory::ioRead7(uint32_t address) {
+    // Count the access if I/O profiling is enabled
+    if (Settings::ioProfiler)
+        core->profiler.countIo(1, 0, sizeof(T), address);
+
     // Mirror the WiFi regions
     if (address >= 0x4808000 && address < 0x4810000)
         address &= ~0x8000;
@@ -1114,6 +1152,7 @@ template <typename T> T Memory::ioRead7(uint32_t address) {
             // Handle unknown reads by returning nothing
             if (i == 0) {
                 LOG_WARN("Unknown ARM7 I/O register read: 0x%X\n", address);
+                core->profiler.countUnknownIo(1, 0, address);
                 return 0;
             }
 
@@ -1130,6 +1169,10 @@ template <typename T> T Memory::ioRead7(uint32_t address) {
 }
 
 template <typename T> T Memory::ioReadGba(uint32_t address) {
+    // Count the access if I/O profiling is enabled
+    if (Settings::ioProfiler)
+        core->profiler.countIo(1, 0, sizeof(T), address);
+
     // Read a value from one or more GBA I/O registers
     T value = 0;
     for (uint32_t i = 0; i < sizeof(T);) {
@@ -1202,6 +1245,7 @@ template <typename T> T Memory::ioReadGba(uint32_t address) {
             // Handle unknown reads by returning nothing
             if (i == 0) {
                 LOG_WARN("Unknown GBA I/O register read: 0x%X\n", address);
+                core->profiler.countUnknownIo(1, 0, address);
                 return 0;
             }
 
@@ -1218,6 +1262,10 @@ template <typename T> T Memory::ioReadGba(uint32_t address) {
 }
 
 template <typename T> void Memory::ioWrite9(uint32_t address, T value) {
+    // Count the access if I/O profiling is enabled
+    if (Settings::ioProfiler)
+        core->profiler.countIo(0, 1, sizeof(T), address);
+
     // Write a value to one or more ARM9 I/O registers
     for (uint32_t i = 0; i < sizeof(T);) {
         // Store data to a register
@@ -1489,6 +1537,7 @@ template <typename T> void Memory::ioWrite9(uint32_t address, T value) {
             // Handle unknown writes by doing nothing
             if (i == 0) {
                 LOG_WARN("Unknown ARM9 I/O register write: 0x%X\n", address);
+                core->profiler.countUnknownIo(0, 1, address);
                 return;
             }
 
@@ -1503,6 +1552,10 @@ template <typename T> void Memory::ioWrite9(uint32_t address, T value) {
 }
 
 template <typename T> void Memory::ioWrite7(uint32_t address, T value) {
+    // Count the access if I/O profiling is enabled
+    if (Settings::ioProfiler)
+        core->profiler.countIo(1, 1, sizeof(T), address);
+
     // Mirror the WiFi regions
     if (address >= 0x4808000 && address < 0x4810000)
         address &= ~0x8000;
@@ -1712,6 +1765,7 @@ template <typename T> void Memory::ioWrite7(uint32_t address, T value) {
             // Handle unknown writes by doing nothing
             if (i == 0) {
                 LOG_WARN("Unknown ARM7 I/O register write: 0x%X\n", address);
+                core->profiler.countUnknownIo(1, 1, address);
                 return;
             }
 
@@ -1726,6 +1780,10 @@ template <typename T> void Memory::ioWrite7(uint32_t address, T value) {
 }
 
 template <typename T> void Memory::ioWriteGba(uint32_t address, T value) {
+    // Count the access if I/O profiling is enabled
+    if (Settings::ioProfiler)
+        core->profiler.countIo(1, 1, sizeof(T), address);
+
     // Write a value to one or more GBA I/O registers
     for (uint32_t i = 0; i < sizeof(T);) {
         // Store data to a register
@@ -1833,6 +1891,7 @@ template <typename T> void Memory::ioWriteGba(uint32_t address, T value) {
             // Handle unknown writes by doing nothing
             if (i == 0) {
                 LOG_WARN("Unknown GBA I/O register write: 0x%X\n", address);
+                core->profiler.countUnknownIo(1, 1, address);
                 return;
             }
 
@@ -1861,6 +1920,8 @@ void Memory::writeVramCnt(int index, uint8_t value) {
 
 void Memory::writeWramCnt(uint8_t value) {
     // Write to the WRAMCNT register and update WRAM mappings
+    // This changes which CPU owns shared WRAM, so it also ends the CPU's quantum
+    core->cpuSync = true;
     wramCnt = value & 0x3;
     updateMap9(0x3000000, 0x4000000);
     updateMap7(0x3000000, 0x4000000);
@@ -58,10 +58,12 @@ public:
     bool loadBios7();
     bool loadGbaBios();
     void copyBiosLogo(uint8_t *logo);
+    uint64_t hashRam();
 
     void updateMap9(uint32_t start, uint32_t end, bool tcm = false);
     void updateMap7(uint32_t start, uint32_t end);
     void updateVram();
+    uint8_t *getWifiRam() { return wifiRam; }
 
     template <typename T> T read(bool arm7, uint32_t address, bool tcm = true);
     template <typename T> void write(bool arm7, uint32_t address, T value, bool tcm = true);
@@ -0,0 +1,202 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "core.h"
+
+// Identifies movie files, and the version of their layout
+#define MOVIE_MAGIC 0x564D4F4E // "NOMV"
+#define MOVIE_VERSION 2
+
+bool Movie::startRecording(std::string path, int hashInterval) {
+    // Create the movie file, replacing any movie in progress
+    stop();
+    warning = "";
+    if (!(file = fopen(path.c_str(), "wb"))) {
+        LOG_WARN("Failed to create movie file: %s\n", path.c_str());
+        return false;
+    }
+
+    // Write a header with the ROM, the time the RTC starts from, and settings that affect timing
+    header = {};
+    header.magic = MOVIE_MAGIC;
+    header.version = MOVIE_VERSION;
+    header.romCode = core->cartridgeNds.getRomCode();
+    header.hashInterval = std::max(hashInterval, 0);
+    header.rtcSeed = std::time(nullptr);
+    getConfig(header);
+    fwrite(&header, sizeof(header), 1, file);
+    LOG_INFO("Recording movie: %s\n", path.c_str());
+    return start(MOVIE_RECORD);
+}
+
+bool Movie::startPlayback(std::string path) {
+    // Open the movie file, replacing any movie in progress
+    stop();
+    warning = "";
+    if (!(file = fopen(path.c_str(), "rb"))) {
+        LOG_WARN("Failed to open movie file: %s\n", path.c_str());
+        return false;
+    }
+
+    // Check that the header is valid and from this version of the layout
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != MOVIE_MAGIC || header.version != MOVIE_VERSION) {
+        LOG_WARN("Invalid movie file: %s\n", path.c_str());
+        stop();
+        return false;
+    }
+
+    // Warn if the movie was recorded with a different ROM or settings, since playback will likely desync
+    // Frontends can show the warning, but playback still goes ahead in case the difference is harmless
+    MovieHeader config = {};
+    getConfig(config);
+    std::string diffs;
+    if (header.romCode != core->cartridgeNds.getRomCode()) diffs += ", ROM";
+    if (header.cpuQuantum != config.cpuQuantum) diffs += ", CPU quantum";
+    if (header.arm7Thread != config.arm7Thread) diffs += ", threaded ARM7";
+    if (header.arm7Hle != config.arm7Hle) diffs += ", HLE ARM7";
+    if (header.dsiMode != config.dsiMode) diffs += ", DSi mode";
+    if (header.directBoot != config.directBoot) diffs += ", direct boot";
+    warning = (diffs != "") ? ("Movie was recorded with different settings (" + diffs.substr(2) + "); playback will likely desync") : "";
+    if (warning != "")
+        LOG_WARN("%s\n", warning.c_str());
+    LOG_INFO("Playing movie: %s\n", path.c_str());
+    return start(MOVIE_PLAY);
+}
+
+void Movie::getConfig(MovieHeader &config) {
+    // Get the current values of settings that change emulation timing
+    config.cpuQuantum = Settings::cpuQuantum;
+    config.arm7Thread = core->arm7Thread.enabled;
+    config.arm7Hle = core->arm7Hle;
+    config.dsiMode = core->dsiMode;
+    config.directBoot = Settings::directBoot;
+}
+
+bool Movie::start(MovieState newState) {
+    // Begin the first frame, with the touchscreen in its current state
+    // Movies are meant to start right after the core is created, so they replay from boot
+    frame = 0;
+    failFrame.store(-1);
+    failReason.store("");
+    touch.store(core->spi.touchX | (core->spi.touchY << 16));
+    state.store(newState);
+    startFrame();
+    return true;
+}
+
+void Movie::stop() {
+    // Close the movie file and return input to the frontend
+    if (state.load() == MOVIE_RECORD)
+        LOG_INFO("Recorded movie with %u frames\n", frame);
+    if (file) fclose(file);
+    file = nullptr;
+    state.store(MOVIE_OFF);
+}
+
+void Movie::nextFrame() {
+    // Finish the frame that just ended, and start the next one if the movie is still going
+    if (state.load() == MOVIE_OFF) return;
+    finishFrame();
+    if (state.load() == MOVIE_OFF) return;
+    frame++;
+    startFrame();
+}
+
+void Movie::startFrame() {
+    if (state.load() == MOVIE_RECORD) {
+        // Capture the input published by the frontend
+        uint32_t pos = touch.load();
+        current = {};
+        current.keys = core->input.getKeys();
+        current.touchX = pos;
+        current.touchY = pos >> 16;
+        micSamples.clear();
+    }
+    else {
+        // Read the next frame's input and microphone samples, finishing at the end of the movie
+        bool valid = (fread(&current, sizeof(current), 1, file) == 1);
+        if (valid) {
+            micSamples.resize(current.micCount);
+            valid = (fread(micSamples.data(), sizeof(uint16_t), current.micCount, file) == current.micCount);
+        }
+        if (!valid) {
+            LOG_INFO("Movie playback finished after %u frames\n", frame);
+            stop();
+            return;
+        }
+    }
+
+    // Hold the input for the whole frame, so the guest sees it the same way every time
+    core->input.hold(current.keys);
+    core->spi.touchX = current.touchX;
+    core->spi.touchY = current.touchY;
+    micIndex = 0;
+    micHash = 0x811C9DC5;
+}
+
+void Movie::finishFrame() {
+    // Hash guest RAM at the end of every interval of frames
+    uint64_t ramHash = 0;
+    if (header.hashInterval && (frame + 1) % header.hashInterval == 0)
+        ramHash = core->memory.hashRam();
+
+    if (state.load() == MOVIE_RECORD) {
+        // Write the frame's input along with the hashes to verify playback against
+        current.micHash = micHash;
+        current.micCount = micSamples.size();
+        current.ramHash = ramHash;
+        fwrite(&current, sizeof(current), 1, file);
+        fwrite(micSamples.data(), sizeof(uint16_t), micSamples.size(), file);
+        return;
+    }
+
+    // Stop playback if the guest diverged from the recording
+    if (micIndex != current.micCount || micHash != current.micHash)
+        fail("microphone reads differ");
+    else if (ramHash != current.ramHash)
+        fail("RAM hash mismatch");
+}
+
+void Movie::fail(const char *reason) {
+    // Report where and why playback diverged so frontends and tools can show it
+    LOG_CRIT("Movie desynced at frame %u: %s\n", frame, reason);
+    failReason.store(reason);
+    failFrame.store(frame);
+    stop();
+}
+
+uint16_t Movie::passMic(uint16_t sample) {
+    // Record microphone samples as the guest reads them, or replace them with recorded ones
+    if (state.load() == MOVIE_RECORD)
+        micSamples.push_back(sample);
+    else
+        sample = (micIndex < micSamples.size()) ? micSamples[micIndex] : 0;
+
+    // Hash the samples so playback can check that the guest read the same ones
+    micIndex++;
+    micHash = (micHash ^ sample) * 0x01000193;
+    return sample;
+}
+
+std::time_t Movie::getTime() {
+    // Advance the RTC from the recorded seed by emulated time, so it reads the same every run
+    return header.rtcSeed + std::time_t(frame * core->framePacer.getBasePeriod());
+}
@@ -0,0 +1,101 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+class Core;
+
+enum MovieState {
+    MOVIE_OFF,
+    MOVIE_RECORD,
+    MOVIE_PLAY
+};
+
+struct MovieHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t romCode;
+    uint32_t hashInterval;
+    int64_t rtcSeed;
+    int32_t cpuQuantum;
+    uint8_t arm7Thread;
+    uint8_t arm7Hle;
+    uint8_t dsiMode;
+    uint8_t directBoot;
+};
+
+struct MovieFrame {
+    uint32_t keys;
+    uint16_t touchX;
+    uint16_t touchY;
+    uint32_t micHash;
+    uint32_t micCount;
+    uint64_t ramHash;
+};
+
+class Movie {
+public:
+    Movie(Core *core): core(core) {}
+    ~Movie() { stop(); }
+
+    bool startRecording(std::string path, int hashInterval = 60);
+    bool startPlayback(std::string path);
+    void stop();
+
+    bool isActive() { return state != MOVIE_OFF; }
+    MovieState getState() { return state; }
+    uint32_t getFrame() { return frame; }
+    int64_t getFailFrame() { return failFrame.load(); }
+    const char *getFailReason() { return failReason.load(); }
+    std::string getWarning() { return warning; }
+
+    void nextFrame();
+    void setTouch(uint16_t x, uint16_t y) { touch.store(x | (y << 16)); }
+    uint16_t passMic(uint16_t sample);
+    std::time_t getTime();
+
+private:
+    Core *core;
+    FILE *file = nullptr;
+    std::atomic<MovieState> state { MOVIE_OFF };
+    MovieHeader header = {};
+    MovieFrame current = {};
+    std::vector<uint16_t> micSamples;
+    std::atomic<uint32_t> touch { 0xFFF00000 };
+
+    uint32_t frame = 0;
+    uint32_t micIndex = 0;
+    uint32_t micHash = 0;
+    std::atomic<int64_t> failFrame { -1 };
+    std::atomic<const char*> failReason { "" };
+    std::string warning;
+
+    bool start(MovieState newState);
+    void getConfig(MovieHeader &config);
+    void startFrame();
+    void finishFrame();
+    void fail(const char *reason);
+};
@@ -0,0 +1,281 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "core.h"
+
+// Bits of a sample key, which packs everything a sample is grouped by
+#define KEY_ARM7 (1ULL << 40)
+#define KEY_HALTED (1ULL << 39)
+#define KEY_THUMB (1ULL << 38)
+#define KEY_MODE(key) (((key) >> 32) & 0x1F)
+
+// Names of I/O registers that are commonly accessed, for the hot register report
+// The mask says which CPUs a name applies to, with bit 0 for the ARM9 and bit 1 for the ARM7
+const IoName Profiler::ioNames[] = {
+    { 0x4000000, 0x1, "DISPCNT" },
+    { 0x4000004, 0x3, "DISPSTAT" },
+    { 0x4000006, 0x3, "VCOUNT" },
+    { 0x4000100, 0x3, "TM0CNT_L" },
+    { 0x4000102, 0x3, "TM0CNT_H" },
+    { 0x4000104, 0x3, "TM1CNT_L" },
+    { 0x4000106, 0x3, "TM1CNT_H" },
+    { 0x4000108, 0x3, "TM2CNT_L" },
+    { 0x400010A, 0x3, "TM2CNT_H" },
+    { 0x400010C, 0x3, "TM3CNT_L" },
+    { 0x400010E, 0x3, "TM3CNT_H" },
+    { 0x4000130, 0x3, "KEYINPUT" },
+    { 0x4000136, 0x2, "EXTKEYIN" },
+    { 0x4000138, 0x2, "RTC" },
+    { 0x4000180, 0x3, "IPCSYNC" },
+    { 0x4000184, 0x3, "IPCFIFOCNT" },
+    { 0x4000188, 0x3, "IPCFIFOSEND" },
+    { 0x40001A0, 0x3, "AUXSPICNT" },
+    { 0x40001A4, 0x3, "ROMCTRL" },
+    { 0x40001C0, 0x2, "SPICNT" },
+    { 0x40001C2, 0x2, "SPIDATA" },
+    { 0x4000208, 0x3, "IME" },
+    { 0x4000210, 0x3, "IE" },
+    { 0x4000214, 0x3, "IF" },
+    { 0x4000280, 0x1, "DIVCNT" },
+    { 0x4000290, 0x1, "DIV_NUMER" },
+    { 0x4000298, 0x1, "DIV_DENOM" },
+    { 0x40002A0, 0x1, "DIV_RESULT" },
+    { 0x40002A8, 0x1, "DIVREM_RESULT" },
+    { 0x40002B0, 0x1, "SQRTCNT" },
+    { 0x40002B4, 0x1, "SQRT_RESULT" },
+    { 0x40002B8, 0x1, "SQRT_PARAM" },
+    { 0x4000300, 0x3, "POSTFLG" },
+    { 0x4000301, 0x2, "HALTCNT" },
+    { 0x4000304, 0x3, "POWCNT" },
+    { 0x4000400, 0x1, "GXFIFO" },
+    { 0x4000500, 0x2, "SOUNDCNT" },
+    { 0x4000600, 0x1, "GXSTAT" },
+    { 0x4100000, 0x3, "IPCFIFORECV" },
+    { 0x4100010, 0x3, "ROMDATA" }
+};
+
+void Profiler::init() {
+    // Read the ARM9 overlay table location from the ROM header
+    uint8_t header[0x58];
+    core->cartridgeNds.readRom(0, sizeof(header), header);
+    uint32_t offset = U8TO32(header, 0x50);
+    uint32_t size = U8TO32(header, 0x54);
+    overlays.clear();
+    if (!offset || !size || size > 0x10000) return;
+
+    // Remember the memory regions overlays are loaded to, including their BSS
+    std::vector<uint8_t> table(size);
+    core->cartridgeNds.readRom(offset, size, &table[0]);
+    for (uint32_t i = 0; i + 0x20 <= size; i += 0x20) {
+        uint32_t start = U8TO32(&table[0], i + 0x4);
+        uint32_t end = start + U8TO32(&table[0], i + 0x8) + U8TO32(&table[0], i + 0xC);
+        overlays.push_back(Overlay(U8TO32(&table[0], i), start, end));
+    }
+    LOG_INFO("Found %d ARM9 overlays for profiling\n", (int)overlays.size());
+}
+
+void Profiler::start(int interval, std::string symbolPath) {
+    // Clear old results and load symbols if a map file is given
+    // This schedules a task, so it should only be called while the core isn't running
+    std::lock_guard<std::mutex> guard(mutex);
+    samples.clear();
+    total = 0;
+    symbols.clear();
+    if (symbolPath != "")
+        loadSymbols(symbolPath);
+
+    // Start sampling CPU state at the given cycle interval
+    this->interval = std::max(interval, 16);
+    if (!scheduled) core->schedule(PROFILER_SAMPLE, this->interval);
+    active = scheduled = true;
+}
+
+void Profiler::stop() {
+    // Stop sampling; the scheduled task will end itself
+    active = false;
+}
+
+void Profiler::rearm() {
+    // Schedule sampling again after the scheduler was reset, like by loading a state or entering GBA mode
+    scheduled = active;
+    if (active) core->schedule(PROFILER_SAMPLE, interval);
+}
+
+void Profiler::sample() {
+    // Stop sampling if disabled, or schedule the next sample
+    if (!(scheduled = active)) return;
+    core->schedule(PROFILER_SAMPLE, interval);
+    std::lock_guard<std::mutex> guard(mutex);
+
+    // Sample both CPUs, skipping ones that aren't emulated
+    for (int i = 0; i < 2; i++) {
+        if ((i == 0 && core->gbaMode) || (i == 1 && core->arm7Hle)) continue;
+        Interpreter &cpu = core->interpreter[i];
+        uint64_t key = i ? KEY_ARM7 : 0;
+
+        // Group halted time separately, or use the address of the next opcode to execute
+        // Between opcodes, the program counter is one opcode ahead of the front of the pipeline
+        if (cpu.halted)
+            key |= KEY_HALTED;
+        else if (cpu.isThumb())
+            key |= KEY_THUMB | (uint64_t(cpu.getMode()) << 32) | (cpu.getPC() - 2);
+        else
+            key |= (uint64_t(cpu.getMode()) << 32) | (cpu.getPC() - 4);
+        samples[key]++;
+        total++;
+    }
+}
+
+bool Profiler::dump(std::string path) {
+    // Sort the samples by count so the report starts with the hottest addresses
+    std::lock_guard<std::mutex> guard(mutex);
+    std::vector<std::pair<uint32_t, uint64_t>> sorted;
+    for (auto it = samples.begin(); it != samples.end(); it++)
+        sorted.push_back(std::make_pair(it->second, it->first));
+    std::sort(sorted.rbegin(), sorted.rend());
+
+    // Write the samples as folded stacks, which flame graph tools read
+    // Each line has the CPU, mode, memory region, symbol, and address as frames, then a sample count
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file) return false;
+    static const char *modes[] = { "USR", "FIQ", "IRQ", "SVC", "", "", "", "ABT", "", "", "", "UND", "", "", "", "SYS" };
+    for (size_t i = 0; i < sorted.size(); i++) {
+        uint64_t key = sorted[i].second;
+        bool arm7 = key & KEY_ARM7;
+        if (key & KEY_HALTED) {
+            fprintf(file, "ARM%d;Halted %u\n", arm7 ? 7 : 9, sorted[i].first);
+            continue;
+        }
+
+        uint32_t address = key;
+        fprintf(file, "ARM%d;%s %s;%s;%s;0x%08X %u\n", arm7 ? 7 : 9, modes[KEY_MODE(key) & 0xF],
+            (key & KEY_THUMB) ? "THUMB" : "ARM", getRegion(arm7, address).c_str(),
+            getSymbol(address).c_str(), address, sorted[i].first);
+    }
+    fclose(file);
+
+    // Log the hottest addresses as a quick summary
+    LOG_INFO("Wrote %u profiler samples to %s\n", total, path.c_str());
+    for (size_t i = 0; i < sorted.size() && i < 10; i++)
+        LOG_INFO("%5.2f%% ARM%d %s 0x%08X %s\n", sorted[i].first * 100.0f / total, (sorted[i].second & KEY_ARM7) ? 7 : 9,
+            (sorted[i].second & KEY_HALTED) ? "halted" : getRegion(sorted[i].second & KEY_ARM7, sorted[i].second).c_str(),
+            uint32_t(sorted[i].second), getSymbol(sorted[i].second).c_str());
+    return true;
+}
+
+void Profiler::loadSymbols(std::string path) {
+    // Load symbols from a map file, with an address and a name on each line
+    // An optional type column between them is skipped, as in nm output
+    FILE *file = fopen(path.c_str(), "r");
+    if (!file) {
+        LOG_WARN("Failed to open symbol file: %s\n", path.c_str());
+        return;
+    }
+
+    char line[512], name[256], type[256];
+    uint32_t address;
+    while (fgets(line, sizeof(line), file)) {
+        int count = sscanf(line, "%x %255s %255s", &address, type, name);
+        if (count == 3 && strlen(type) == 1)
+            symbols.push_back(Symbol(address, name));
+        else if (count >= 2)
+            symbols.push_back(Symbol(address, type));
+    }
+    fclose(file);
+
+    // Sort the symbols so the closest one before an address can be found quickly
+    std::sort(symbols.begin(), symbols.end());
+    LOG_INFO("Loaded %d symbols for profiling\n", (int)symbols.size());
+}
+
+std::string Profiler::getRegion(bool arm7, uint32_t address) {
+    // Name the ARM9 overlays an address could belong to, since they share memory
+    std::string region;
+    if (!arm7) {
+        for (size_t i = 0; i < overlays.size(); i++) {
+            if (address < overlays[i].start || address >= overlays[i].end) continue;
+            region += (region == "") ? "Overlay " : "/";
+            region += std::to_string(overlays[i].id);
+        }
+        if (region != "") return region;
+    }
+
+    // Otherwise name the memory area an address is in
+    switch (address >> 24) {
+    case 0x00: return (!arm7 && address < core->cp15.itcmSize) ? "ITCM" : "BIOS";
+    case 0x01: return arm7 ? "Unmapped" : "ITCM";
+    case 0x02: return "Main RAM";
+    case 0x03: return "WRAM";
+    case 0x06: return "VRAM";
+    case 0x08: case 0x09: return "GBA ROM";
+    case 0xFF: return arm7 ? "Unmapped" : "BIOS";
+    default: return (!arm7 && address - core->cp15.dtcmAddr < core->cp15.dtcmSize) ? "DTCM" : "Unmapped";
+    }
+}
+
+std::string Profiler::getSymbol(uint32_t address) {
+    // Find the closest symbol at or before an address, if there are any
+    auto it = std::upper_bound(symbols.begin(), symbols.end(), Symbol(address, ""));
+    if (it == symbols.begin()) return "?";
+    return (--it)->name;
+}
+
+void Profiler::reportIo() {
+    // Report once per second of emulation, assuming 60 frames per second
+    if (++ioFrames < 60) return;
+    double seconds = ioFrames * core->framePacer.getBasePeriod();
+    ioFrames = 0;
+
+    // Sort the accesses from both CPUs by count and reset them for the next second
+    std::vector<std::pair<uint32_t, uint64_t>> sorted;
+    for (int i = 0; i < 2; i++) {
+        for (auto it = ioCounts[i].begin(); it != ioCounts[i].end(); it++)
+            sorted.push_back(std::make_pair(it->second, it->first | (uint64_t(i) << 5)));
+        ioCounts[i].clear();
+    }
+    std::sort(sorted.rbegin(), sorted.rend());
+
+    // Write the most accessed registers to a file in the base folder, replacing the last second's report
+    // The number of registers shown is set by the setting, and each core has its own file
+    std::string path = Settings::basePath + "/noods-io" + (core->id ? std::to_string(core->id + 1) : "") + ".txt";
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file) return;
+    fprintf(file, "Hot I/O registers per second of emulation:\n");
+    for (size_t i = 0; i < sorted.size() && i < (size_t)Settings::ioProfiler; i++) {
+        uint64_t key = sorted[i].second;
+        bool arm7 = (key >> 5) & 0x1;
+        uint32_t address = key >> 8;
+        const char *name = getIoName(arm7, address);
+        fprintf(file, "%9.0f %s %s%d 0x%08X %s\n", sorted[i].first / seconds, core->gbaMode ? "GBA " : (arm7 ? "ARM7" : "ARM9"),
+            ((key >> 4) & 0x1) ? "W" : "R", int(key & 0xF) * 8, address, name ? name : "");
+    }
+    fclose(file);
+}
+
+const char *Profiler::getIoName(bool arm7, uint32_t address) {
+    // Look up the name of a register, which is only known for the NDS
+    if (core->gbaMode) return nullptr;
+    for (size_t i = 0; i < sizeof(ioNames) / sizeof(IoName); i++)
+        if (ioNames[i].address == address && (ioNames[i].cpus & BIT(arm7)))
+            return ioNames[i].name;
+    return nullptr;
+}
@@ -0,0 +1,104 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Core;
+
+struct Overlay {
+    uint32_t id;
+    uint32_t start;
+    uint32_t end;
+
+    Overlay(uint32_t id, uint32_t start, uint32_t end): id(id), start(start), end(end) {}
+};
+
+struct IoName {
+    uint32_t address;
+    uint8_t cpus;
+    const char *name;
+};
+
+struct Symbol {
+    uint32_t address;
+    std::string name;
+
+    Symbol(uint32_t address, std::string name): address(address), name(name) {}
+    bool operator<(const Symbol &symbol) const { return address < symbol.address; }
+};
+
+class Profiler {
+public:
+    Profiler(Core *core): core(core) {}
+
+    void init();
+    bool isActive() { return active; }
+    void start(int interval, std::string symbolPath = "");
+    void stop();
+    void rearm();
+    bool dump(std::string path);
+    void sample();
+
+    void countIo(bool arm7, bool write, uint8_t size, uint32_t address);
+    void countUnknownIo(bool arm7, bool write, uint32_t address);
+    void trackUnknownIo(bool enabled) { unknownIoEnabled = enabled; }
+    void reportIo();
+    const std::unordered_map<uint64_t, uint32_t> &getUnknownIo(bool arm7) { return unknownIo[arm7]; }
+
+private:
+    Core *core;
+    bool active = false;
+    bool scheduled = false;
+    int interval = 0;
+    uint32_t total = 0;
+    std::mutex mutex;
+
+    std::unordered_map<uint64_t, uint32_t> samples;
+    std::vector<Overlay> overlays;
+    std::vector<Symbol> symbols;
+
+    static const IoName ioNames[];
+    std::unordered_map<uint64_t, uint32_t> ioCounts[2];
+    std::unordered_map<uint64_t, uint32_t> unknownIo[2];
+    bool unknownIoEnabled = false;
+    int ioFrames = 0;
+
+    void loadSymbols(std::string path);
+    std::string getRegion(bool arm7, uint32_t address);
+    std::string getSymbol(uint32_t address);
+    const char *getIoName(bool arm7, uint32_t address);
+};
+
+inline void Profiler::countIo(bool arm7, bool write, uint8_t size, uint32_t address) {
+    // Count an I/O access, keyed by address, direction, and width
+    // Each CPU has its own table, so they can count without locking when the ARM7 is threaded
+    ioCounts[arm7][(uint64_t(address) << 8) | (write << 4) | size]++;
+}
+
+inline void Profiler::countUnknownIo(bool arm7, bool write, uint32_t address) {
+    // Count an access to an unknown I/O register, keyed by address and direction, if a tool asked to report them
+    if (unknownIoEnabled)
+        unknownIo[arm7][(uint64_t(address) << 1) | write]++;
+}
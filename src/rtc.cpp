@@ -89,9 +89,10 @@ void Rtc::updateRtc(bool cs, bool sck, bool sio) {
 }
 
 void Rtc::updateDateTime() {
-    // Get the local time
-    std::time_t t = std::time(nullptr);
-    std::tm *time = std::localtime(&t);
+    // Get the local time, or time from the seed in UTC if a movie is active
+    bool movie = core->movie.isActive();
+    std::time_t t = movie ? core->movie.getTime() : std::time(nullptr);
+    std::tm *time = movie ? std::gmtime(&t) : std::localtime(&t);
     time->tm_year %= 100; // The DS only counts years 2000-2099
     time->tm_mon++; // The DS starts month values at 1, not 0
 
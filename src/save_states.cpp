@@ -20,7 +20,7 @@
 #include "core.h"
 
 const char *SaveStates::stateTag = "NOOD";
-const uint32_t SaveStates::stateVersion = 7;
+const uint32_t SaveStates::stateVersion = 8;
 
 void SaveStates::setPath(std::string path, bool gba) {
     // Set the NDS or GBA state path
@@ -23,7 +23,16 @@
 int Settings::directBoot = 1;
 int Settings::romInRam = 0;
 int Settings::fpsLimiter = 1;
+int Settings::framePacer = 0;
+int Settings::pacerSpeed = 100;
+int Settings::turboSpeed = 2;
+int Settings::inputLatch = 0;
+int Settings::wifiLockstep = 0;
+int Settings::wifiRemote = 0;
 int Settings::frameskip = 0;
+int Settings::adaptiveSkip = 0;
+int Settings::adaptiveRes3D = 0;
+int Settings::cpuQuantum = 0;
 int Settings::threaded2D = 1;
 int Settings::threaded3D = 1;
 int Settings::highRes3D = 0;
@@ -36,19 +45,32 @@ int Settings::cheatsFolder = 1;
 int Settings::screenFilter = 2;
 int Settings::arm7Hle = 0;
 int Settings::dsiMode = 0;
+int Settings::arm7Thread = 0;
+int Settings::ioProfiler = 0;
 
 std::string Settings::bios9Path = "bios9.bin";
 std::string Settings::bios7Path = "bios7.bin";
 std::string Settings::firmwarePath = "firmware.bin";
 std::string Settings::gbaBiosPath = "gba_bios.bin";
 std::string Settings::sdImagePath = "sd.img";
+std::string Settings::wifiRendezvous = "";
+std::string Settings::arm7ThreadGames = "";
 std::string Settings::basePath = ".";
 
 std::vector<Setting> Settings::settings = {
     Setting("directBoot", &directBoot, false),
     Setting("romInRam", &romInRam, false),
     Setting("fpsLimiter", &fpsLimiter, false),
+    Setting("framePacer", &framePacer, false),
+    Setting("pacerSpeed", &pacerSpeed, false),
+    Setting("turboSpeed", &turboSpeed, false),
+    Setting("inputLatch", &inputLatch, false),
+    Setting("wifiLockstep", &wifiLockstep, false),
+    Setting("wifiRemote", &wifiRemote, false),
     Setting("frameskip", &frameskip, false),
+    Setting("adaptiveSkip", &adaptiveSkip, false),
+    Setting("adaptiveRes3D", &adaptiveRes3D, false),
+    Setting("cpuQuantum", &cpuQuantum, false),
     Setting("threaded2D", &threaded2D, false),
     Setting("threaded3D", &threaded3D, false),
     Setting("highRes3D", &highRes3D, false),
@@ -61,11 +83,15 @@ std::vector<Setting> Settings::settings = {
     Setting("screenFilter", &screenFilter, false),
     Setting("arm7Hle", &arm7Hle, false),
     Setting("dsiMode", &dsiMode, false),
+    Setting("arm7Thread", &arm7Thread, false),
+    Setting("ioProfiler", &ioProfiler, false),
     Setting("bios9Path", &bios9Path, true),
     Setting("bios7Path", &bios7Path, true),
     Setting("firmwarePath", &firmwarePath, true),
     Setting("gbaBiosPath", &gbaBiosPath, true),
-    Setting("sdImagePath", &sdImagePath, true)
+    Setting("sdImagePath", &sdImagePath, true),
+    Setting("wifiRendezvous", &wifiRendezvous, true),
+    Setting("arm7ThreadGames", &arm7ThreadGames, true)
 };
 
 void Settings::add(std::vector<Setting> &settings) {
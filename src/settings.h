@@ -36,7 +36,16 @@ public:
     static int directBoot;
     static int romInRam;
     static int fpsLimiter;
+    static int framePacer;
+    static int pacerSpeed;
+    static int turboSpeed;
+    static int inputLatch;
+    static int wifiLockstep;
+    static int wifiRemote;
     static int frameskip;
+    static int adaptiveSkip;
+    static int adaptiveRes3D;
+    static int cpuQuantum;
     static int threaded2D;
     static int threaded3D;
     static int highRes3D;
@@ -49,12 +58,16 @@ public:
     static int screenFilter;
     static int arm7Hle;
     static int dsiMode;
+    static int arm7Thread;
+    static int ioProfiler;
 
     static std::string bios9Path;
     static std::string bios7Path;
     static std::string firmwarePath;
     static std::string gbaBiosPath;
     static std::string sdImagePath;
+    static std::string wifiRendezvous;
+    static std::string arm7ThreadGames;
     static std::string basePath;
 
     static void add(std::vector<Setting> &settings);
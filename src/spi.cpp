@@ -187,12 +187,25 @@ void Spi::setTouch(int x, int y) {
     if (y < 1) y = 1; else if (y > 190) y = 190;
 
     // Convert the coordinates to ADC values
-    if (scrX2 - scrX1 != 0) touchX = (x - (scrX1 - 1)) * (adcX2 - adcX1) / (scrX2 - scrX1) + adcX1;
-    if (scrY2 - scrY1 != 0) touchY = (y - (scrY1 - 1)) * (adcY2 - adcY1) / (scrY2 - scrY1) + adcY1;
+    uint16_t adcX = touchX, adcY = touchY;
+    if (scrX2 - scrX1 != 0) adcX = (x - (scrX1 - 1)) * (adcX2 - adcX1) / (scrX2 - scrX1) + adcX1;
+    if (scrY2 - scrY1 != 0) adcY = (y - (scrY1 - 1)) * (adcY2 - adcY1) / (scrY2 - scrY1) + adcY1;
+
+    // Pass the values to a movie so they only change on frame boundaries, or set them directly
+    if (core->movie.isActive()) {
+        core->movie.setTouch(adcX, adcY);
+        return;
+    }
+    touchX = adcX;
+    touchY = adcY;
 }
 
 void Spi::clearTouch() {
-    // Set the ADC values to their default state
+    // Set the ADC values to their default state, through a movie if one is active
+    if (core->movie.isActive()) {
+        core->movie.setTouch(0x000, 0xFFF);
+        return;
+    }
     touchX = 0x000;
     touchY = 0xFFF;
 }
@@ -279,6 +292,10 @@ void Spi::writeSpiData(uint8_t value) {
                     micSample = (micBufSize > 0) ? ((micBuffer[index] >> 4) + 0x800) : 0;
                     mutex.unlock();
 
+                    // Let a movie record the sample, or replace it during playback
+                    if (core->movie.isActive())
+                        micSample = core->movie.passMic(micSample);
+
                     // Send the most significant 7 bits of the sample first
                     spiData = micSample >> 5;
                     break;
@@ -37,7 +37,7 @@ const int16_t Spu::adpcmTable[] = {
     0x5771, 0x602F, 0x69CE, 0x7462, 0x7FFF
 };
 
-Spu::Spu(Core *core): core(core) {
+Spu::Spu(Core *core): core(core), waitTime(0) {
     // Mark the buffer as not ready
     ready.store(false);
 }
@@ -154,6 +154,20 @@ void Spu::loadState(FILE *file) {
     }
 }
 
+std::chrono::steady_clock::duration Spu::popWaitTime() {
+    // Get the time spent waiting for audio since the last call and reset it
+    std::chrono::steady_clock::duration time = waitTime;
+    waitTime = std::chrono::steady_clock::duration::zero();
+    return time;
+}
+
+uint32_t Spu::takeSampleHash() {
+    // Get the hash of samples generated since the last call, and start a new one
+    uint32_t hash = sampleHash;
+    sampleHash = 0x811C9DC5;
+    return hash;
+}
+
 uint32_t *Spu::getSamples(int count) {
     // Initialize the buffers
     if (bufferSize != count) {
@@ -691,22 +705,50 @@ void Spu::runSample() {
 }
 
 void Spu::pushSample(int16_t sampleLeft, int16_t sampleRight) {
+    // Hash the samples as they're generated, so output can be checked even if nothing plays it
+    uint32_t sample = (sampleRight << 16) | (sampleLeft & 0xFFFF);
+    sampleHash = (sampleHash ^ sample) * 0x01000193;
+
     // Write the samples to the buffer
     if (!bufferSize) return;
-    bufferIn[bufferPointer++] = (sampleRight << 16) | (sampleLeft & 0xFFFF);
+    bufferIn[bufferPointer++] = sample;
     if (bufferPointer != bufferSize) return;
 
+    if (core->turbo) {
+        // Time-stretch the audio in turbo mode so it plays at normal speed without blocking emulation
+        stretch.setTempo(core->speed);
+        stretch.putSamples(bufferIn, bufferSize);
+        bufferPointer = 0;
+
+        // Only hand off a buffer once the last one was played, and drop excess output to limit latency
+        stretch.trimOutput(bufferSize * 4);
+        if (ready.load() || stretch.available() < (int)bufferSize) return;
+        stretch.receiveSamples(bufferIn, bufferSize);
+    }
+    else {
+        // Reset the stretching state so turbo mode starts fresh
+        stretch.clear();
+    }
+
     // Wait until the buffer has been played, keeping the emulator throttled to 60 FPS
     // Synchronizing to the audio eliminites the potential for nasty audio crackles
-    if (Settings::fpsLimiter == 2) { // Accurate
-        std::chrono::steady_clock::time_point waitTime = std::chrono::steady_clock::now();
-        while (ready.load() && std::chrono::steady_clock::now() - waitTime <= std::chrono::microseconds(1000000));
+    // This is skipped when the frame pacer or turbo mode are active, since they throttle the emulator instead
+    int limiter = (Settings::framePacer || core->turbo) ? 0 : Settings::fpsLimiter;
+    std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+    if (limiter == 2) { // Accurate
+        TraceScope scope("pushSampleWait");
+        while (ready.load() && std::chrono::steady_clock::now() - waitStart <= std::chrono::microseconds(1000000));
     }
-    else if (Settings::fpsLimiter == 1) { // Light
+    else if (limiter == 1) { // Light
+        TraceScope scope("pushSampleWait");
         std::unique_lock<std::mutex> lock(mutex1);
         cond1.wait_for(lock, std::chrono::microseconds(1000000), [&]{ return !ready.load(); });
     }
 
+    // Track the time spent waiting so it can be excluded from frame timing
+    if (limiter)
+        waitTime += std::chrono::steady_clock::now() - waitStart;
+
     // Swap the buffers
     SWAP(bufferOut, bufferIn);
 
@@ -20,12 +20,15 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <cstdio>
 #include <queue>
 #include <mutex>
 
+#include "time_stretch.h"
+
 class Core;
 
 class Spu {
@@ -37,6 +40,8 @@ public:
     void loadState(FILE *file);
 
     uint32_t *getSamples(int count);
+    std::chrono::steady_clock::duration popWaitTime();
+    uint32_t takeSampleHash();
     void runGbaSample();
     void runSample();
     void gbaFifoTimer(int timer);
@@ -87,6 +92,9 @@ private:
     std::condition_variable cond1, cond2;
     std::mutex mutex1, mutex2;
     std::atomic<bool> ready;
+    std::chrono::steady_clock::duration waitTime;
+    uint32_t sampleHash = 0x811C9DC5;
+    TimeStretch stretch;
 
     int16_t gbaFrameSequencer = 0;
     int32_t gbaSoundTimers[4] = {};
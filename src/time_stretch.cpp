@@ -0,0 +1,124 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "time_stretch.h"
+
+// Segment lengths in samples, tuned for the 32768Hz output of the SPU
+// Each segment is 40ms long, crossfaded over 8ms, and its splice point is searched for within 15ms
+#define SEQ_LENGTH 1310
+#define OVERLAP_LENGTH 262
+#define SEEK_LENGTH 492
+
+// Get the mono value of a packed stereo sample
+#define MONO(sample) ((int16_t)(sample) + (int16_t)((sample) >> 16))
+
+void TimeStretch::setTempo(double tempo) {
+    // Set the ratio of input to output samples, within reasonable bounds
+    this->tempo = std::max(0.5, std::min(16.0, tempo));
+}
+
+void TimeStretch::putSamples(const uint32_t *samples, int count) {
+    // Add samples to the input and stretch as many as possible
+    input.insert(input.end(), samples, samples + count);
+    process();
+}
+
+int TimeStretch::receiveSamples(uint32_t *out, int count) {
+    // Move stretched samples from the front of the output
+    count = std::min<int>(count, output.size());
+    std::copy(output.begin(), output.begin() + count, out);
+    output.erase(output.begin(), output.begin() + count);
+    return count;
+}
+
+void TimeStretch::trimOutput(int count) {
+    // Drop the oldest output samples to limit latency if they aren't being consumed
+    if (output.size() > (size_t)count)
+        output.erase(output.begin(), output.end() - count);
+}
+
+void TimeStretch::clear() {
+    // Reset the stretching state
+    input.clear();
+    output.clear();
+    primed = false;
+    skipFract = 0.0;
+}
+
+int TimeStretch::seekBestOffset() {
+    // Find the input offset that best continues the previous segment's overlap
+    // This uses cross-correlation normalized by the input energy, on mono samples
+    double bestCorr = -1e30;
+    int bestOffset = 0;
+    for (int offset = 0; offset < SEEK_LENGTH; offset++) {
+        int64_t corr = 0, norm = 0;
+        for (int i = 0; i < OVERLAP_LENGTH; i++) {
+            int32_t value = MONO(input[offset + i]);
+            corr += (int64_t)MONO(overlap[i]) * value;
+            norm += (int64_t)value * value;
+        }
+
+        // Keep track of the best match so far
+        double score = corr / std::sqrt((double)std::max<int64_t>(norm, 1));
+        if (score > bestCorr) {
+            bestCorr = score;
+            bestOffset = offset;
+        }
+    }
+    return bestOffset;
+}
+
+void TimeStretch::process() {
+    // Seed the overlap with the first input samples so output doesn't fade in from silence
+    if (!primed) {
+        if (input.size() < OVERLAP_LENGTH) return;
+        overlap.assign(input.begin(), input.begin() + OVERLAP_LENGTH);
+        input.erase(input.begin(), input.begin() + OVERLAP_LENGTH);
+        primed = true;
+    }
+
+    // Output a segment each time there's enough input to search and consume it
+    while (true) {
+        double skip = skipFract + (SEQ_LENGTH - OVERLAP_LENGTH) * tempo;
+        if (input.size() < std::max<size_t>(SEQ_LENGTH + SEEK_LENGTH, skip + 1)) break;
+        int offset = seekBestOffset();
+
+        // Crossfade from the previous segment's overlap into the best matching input
+        for (int i = 0; i < OVERLAP_LENGTH; i++) {
+            uint32_t a = overlap[i], b = input[offset + i];
+            int16_t left = ((int16_t)a * (OVERLAP_LENGTH - i) + (int16_t)b * i) / OVERLAP_LENGTH;
+            int16_t right = ((int16_t)(a >> 16) * (OVERLAP_LENGTH - i) + (int16_t)(b >> 16) * i) / OVERLAP_LENGTH;
+            output.push_back((right << 16) | (left & 0xFFFF));
+        }
+
+        // Copy the middle of the segment, and save its end to crossfade with the next one
+        output.insert(output.end(), input.begin() + offset + OVERLAP_LENGTH,
+            input.begin() + offset + SEQ_LENGTH - OVERLAP_LENGTH);
+        std::copy(input.begin() + offset + SEQ_LENGTH - OVERLAP_LENGTH, input.begin() + offset + SEQ_LENGTH, overlap.begin());
+
+        // Advance the input by the segment length scaled by the tempo
+        // The fractional part is carried over to keep the average rate exact
+        int count = skip;
+        skipFract = skip - count;
+        input.erase(input.begin(), input.begin() + count);
+    }
+}
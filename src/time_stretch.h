@@ -0,0 +1,46 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Changes the tempo of a stereo sample stream without affecting its pitch
+// This uses WSOLA, which splices together overlapping segments of the input at their most similar points
+class TimeStretch {
+public:
+    void setTempo(double tempo);
+    void putSamples(const uint32_t *samples, int count);
+    int receiveSamples(uint32_t *out, int count);
+    int available() { return output.size(); }
+    void trimOutput(int count);
+    void clear();
+
+private:
+    std::vector<uint32_t> input;
+    std::vector<uint32_t> output;
+    std::vector<uint32_t> overlap;
+    bool primed = false;
+    double tempo = 1.0;
+    double skipFract = 0.0;
+
+    int seekBestOffset();
+    void process();
+};
@@ -38,16 +38,54 @@ void Timers::loadState(FILE *file) {
 }
 
 void Timers::resetCycles() {
-    // Adjust timer end cycles for a global cycle reset
-    for (int i = 0; i < 4; i++)
+    // Adjust timer end cycles for a global cycle reset, catching up lazy timers first
+    for (int i = 0; i < 4; i++) {
+        syncTimer(i);
         endCycles[i] -= core->globalCycles;
+    }
+}
+
+bool Timers::onScheduler(int timer) {
+    // Check if a timer is enabled and not in count-up mode, so its value is based on the cycle count
+    return (tmCntH[timer] & BIT(7)) && (timer == 0 || !(tmCntH[timer] & BIT(2)));
+}
+
+bool Timers::needsEvents(int timer) {
+    // Check if a timer's overflows have any effect other than reloading it
+    // This is the case if its IRQ is enabled, it can tick a count-up timer, or it can drive a GBA sound FIFO
+    return (tmCntH[timer] & BIT(6)) || (timer < 3 && (tmCntH[timer + 1] & BIT(2))) || (core->gbaMode && timer < 2);
+}
+
+void Timers::syncTimer(int timer) {
+    // Catch up on overflows of a timer that's running without events
+    if (onScheduler(timer) && !needsEvents(timer))
+        skipOverflows(timer);
+}
+
+void Timers::skipOverflows(int timer) {
+    // Advance the end cycle past any overflows that have already happened
+    // These only reload the timer, so they're skipped in one step instead of flooding the scheduler
+    // A pending overflow is never more than a full counter range away, so anything further is in the past
+    uint32_t end = endCycles[timer] - core->globalCycles;
+    if (end != 0 && end <= (0x10000U << shifts[timer])) return;
+    uint32_t period = (0x10000 - tmCntL[timer]) << shifts[timer];
+    endCycles[timer] += ((core->globalCycles - endCycles[timer]) / period + 1) * period;
+}
+
+void Timers::updateEvents(int timer, bool needed) {
+    // Schedule the next overflow of a running timer if it just started needing events
+    // If it stopped needing them instead, the pending event is ignored once it fires
+    if (!onScheduler(timer) || needed || !needsEvents(timer)) return;
+    skipOverflows(timer);
+    core->schedule(SchedTask(TIMER9_OVERFLOW0 + (arm7 << 2) + timer), endCycles[timer] - core->globalCycles);
 }
 
 void Timers::overflow(int timer) {
     // Ensure the timer is enabled and the end cycle is correct if not in count-up mode
     // The end cycle check ensures that if a timer was changed while running, outdated events are ignored
+    // Events are also ignored if the timer stopped needing them, since it's then updated lazily
     if (!(tmCntH[timer] & BIT(7)) || ((timer == 0 || !(tmCntH[timer] & BIT(2)))
-        && endCycles[timer] != core->globalCycles)) return;
+        && (endCycles[timer] != core->globalCycles || !needsEvents(timer)))) return;
 
     // Reload the timer and schedule another overflow if not in count-up mode
     timers[timer] = tmCntL[timer];
@@ -71,12 +109,20 @@ void Timers::overflow(int timer) {
 }
 
 void Timers::writeTmCntL(int timer, uint16_t mask, uint16_t value) {
+    // Apply any skipped overflows with the old reload value
+    syncTimer(timer);
+
     // Write to one of the TMCNT_L registers
     // This value doesn't affect the current counter, and is instead used as the reload value
     tmCntL[timer] = (tmCntL[timer] & ~mask) | (value & mask);
 }
 
 void Timers::writeTmCntH(int timer, uint16_t mask, uint16_t value) {
+    // Catch up the timer, and track if it and the previous timer need events before the write
+    syncTimer(timer);
+    bool needed = needsEvents(timer);
+    bool prevNeeded = (timer > 0 && needsEvents(timer - 1));
+
     // Update the current timer value if it's running on the scheduler
     bool dirty = false;
     if ((tmCntH[timer] & BIT(7)) && (timer == 0 || !(value & BIT(2))))
@@ -102,15 +148,24 @@ void Timers::writeTmCntH(int timer, uint16_t mask, uint16_t value) {
     mask &= 0x00C7;
     tmCntH[timer] = (tmCntH[timer] & ~mask) | (value & mask);
 
-    // Schedule a timer overflow if the timer changed and isn't in count-up mode
-    if (dirty && (tmCntH[timer] & BIT(7)) && (timer == 0 || !(tmCntH[timer] & BIT(2)))) {
-        core->schedule(SchedTask(TIMER9_OVERFLOW0 + (arm7 << 2) + timer), (0x10000 - timers[timer]) << shifts[timer]);
+    // Set a new overflow time if the timer changed and isn't in count-up mode
+    // An event is only scheduled if overflows have other effects; otherwise the timer is updated lazily
+    if (dirty && onScheduler(timer)) {
         endCycles[timer] = core->globalCycles + ((0x10000 - timers[timer]) << shifts[timer]);
+        if (needsEvents(timer))
+            core->schedule(SchedTask(TIMER9_OVERFLOW0 + (arm7 << 2) + timer), (0x10000 - timers[timer]) << shifts[timer]);
     }
+    else
+        updateEvents(timer, needed);
+
+    // Update the previous timer's events in case count-up timing changed
+    if (timer > 0)
+        updateEvents(timer - 1, prevNeeded);
 }
 
 uint16_t Timers::readTmCntL(int timer) {
     // Read the current timer value, updating it if it's running on the scheduler
+    syncTimer(timer);
     if ((tmCntH[timer] & BIT(7)) && (timer == 0 || !(tmCntH[timer] & BIT(2))))
         timers[timer] = 0x10000 - ((endCycles[timer] - core->globalCycles) >> shifts[timer]);
     return timers[timer];
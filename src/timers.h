@@ -49,4 +49,10 @@ private:
 
     uint16_t tmCntL[4] = {};
     uint16_t tmCntH[4] = {};
+
+    bool onScheduler(int timer);
+    bool needsEvents(int timer);
+    void syncTimer(int timer);
+    void skipOverflows(int timer);
+    void updateEvents(int timer, bool needed);
 };
@@ -0,0 +1,171 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "trace.h"
+#include "defines.h"
+
+// The number of events kept per thread, which must be a power of 2
+#define RING_SIZE 0x10000
+
+struct TraceRing {
+    std::string name;
+    int id;
+    bool detached = false;
+    std::atomic<bool> writing = { false };
+    std::atomic<uint32_t> count = { 0 };
+    TraceEvent events[RING_SIZE];
+};
+
+struct TraceThread {
+    TraceRing *ring = nullptr;
+    const char *name = nullptr;
+
+    // Let the ring outlive its thread so its events can still be dumped
+    ~TraceThread() { if (ring) Trace::detach(ring); }
+};
+
+static thread_local TraceThread traceThread;
+static std::chrono::steady_clock::time_point origin;
+
+std::atomic<bool> Trace::enabled = { false };
+std::mutex Trace::mutex;
+std::vector<TraceRing*> Trace::rings;
+int Trace::nextId = 0;
+
+void Trace::start() {
+    // Free rings from threads that have exited, and clear the rest
+    std::lock_guard<std::mutex> guard(mutex);
+    for (size_t i = 0; i < rings.size(); i++) {
+        if (rings[i]->detached) {
+            delete rings[i];
+            rings.erase(rings.begin() + i--);
+            continue;
+        }
+        rings[i]->count.store(0);
+    }
+
+    // Start recording with timestamps relative to now
+    origin = std::chrono::steady_clock::now();
+    enabled.store(true);
+    LOG_INFO("Started recording trace events\n");
+}
+
+void Trace::stop() {
+    // Stop recording, and wait for any events that are still being written
+    enabled.store(false);
+    std::lock_guard<std::mutex> guard(mutex);
+    for (size_t i = 0; i < rings.size(); i++)
+        while (rings[i]->writing.load())
+            std::this_thread::yield();
+}
+
+bool Trace::dump(std::string path) {
+    // Stop recording so the rings don't change while they're written out
+    stop();
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    // Write the events from each thread's ring in the Chrome trace event format, oldest first
+    std::lock_guard<std::mutex> guard(mutex);
+    uint32_t total = 0;
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"NooDS\"}}");
+    for (size_t i = 0; i < rings.size(); i++) {
+        TraceRing *ring = rings[i];
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            ring->id, ring->name.c_str());
+
+        uint32_t count = ring->count.load();
+        for (uint32_t j = (count > RING_SIZE) ? (count - RING_SIZE) : 0; j < count; j++, total++) {
+            TraceEvent &event = ring->events[j & (RING_SIZE - 1)];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                event.name, ring->id, event.start / 1000.0, event.length / 1000.0);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    LOG_INFO("Wrote %u trace events to %s\n", total, path.c_str());
+    return true;
+}
+
+void Trace::nameThread(const char *name) {
+    // Set a name to show for the current thread's events
+    if (traceThread.name == name) return;
+    traceThread.name = name;
+    if (traceThread.ring) {
+        std::lock_guard<std::mutex> guard(mutex);
+        traceThread.ring->name = name;
+    }
+}
+
+int64_t Trace::now() {
+    // Get the current time in nanoseconds since recording started
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+TraceRing *Trace::getRing() {
+    // Get the current thread's ring, setting one up the first time it records an event
+    if (TraceRing *ring = traceThread.ring)
+        return ring;
+    std::lock_guard<std::mutex> guard(mutex);
+
+    // Reuse the ring of an exited thread with the same name, since some threads are restarted every frame
+    if (traceThread.name) {
+        for (size_t i = 0; i < rings.size(); i++) {
+            if (!rings[i]->detached || rings[i]->name != traceThread.name) continue;
+            rings[i]->detached = false;
+            return traceThread.ring = rings[i];
+        }
+    }
+
+    // Create a new ring otherwise
+    TraceRing *ring = new TraceRing();
+    ring->id = ++nextId;
+    ring->name = traceThread.name ? traceThread.name : ("Thread " + std::to_string(ring->id));
+    rings.push_back(ring);
+    return traceThread.ring = ring;
+}
+
+void Trace::record(const char *name, int64_t start) {
+    // Add an event to the current thread's ring, overwriting the oldest once it's full
+    // The writing flag lets a dump wait for this, since recording can stop at any time
+    int64_t end = now();
+    TraceRing *ring = getRing();
+    ring->writing.store(true);
+    if (enabled.load()) {
+        uint32_t count = ring->count.load(std::memory_order_relaxed);
+        TraceEvent &event = ring->events[count & (RING_SIZE - 1)];
+        event.name = name;
+        event.start = start;
+        event.length = end - start;
+        ring->count.store(count + 1, std::memory_order_release);
+    }
+    ring->writing.store(false);
+}
+
+void Trace::detach(TraceRing *ring) {
+    // Mark a ring as belonging to an exited thread, so it can be freed on the next start
+    std::lock_guard<std::mutex> guard(mutex);
+    ring->detached = true;
+}
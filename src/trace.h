@@ -0,0 +1,70 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TraceEvent {
+    const char *name;
+    int64_t start;
+    int64_t length;
+};
+
+struct TraceRing;
+
+class Trace {
+public:
+    static std::atomic<bool> enabled;
+
+    static void start();
+    static void stop();
+    static bool dump(std::string path);
+
+    static void nameThread(const char *name);
+    static int64_t now();
+    static void record(const char *name, int64_t start);
+    static void detach(TraceRing *ring);
+
+private:
+    static std::mutex mutex;
+    static std::vector<TraceRing*> rings;
+    static int nextId;
+
+    static TraceRing *getRing();
+};
+
+class TraceScope {
+public:
+    TraceScope(const char *name): name(Trace::enabled.load(std::memory_order_relaxed) ? name : nullptr) {
+        if (this->name) start = Trace::now();
+    }
+
+    ~TraceScope() {
+        if (name) Trace::record(name, start);
+    }
+
+private:
+    const char *name;
+    int64_t start = 0;
+};
@@ -18,9 +18,20 @@
 */
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
 #include "core.h"
 
 #define MS_CYCLES 34418
+#define MAX_MS_SKIP 1024
+#define CMD_STEP (0x400 / 10)
+
+static inline uint32_t msUntilValue(uint16_t count, uint16_t value) {
+    // Get the milliseconds until a decrementing counter reaches a value, including a full wrap
+    uint16_t ms = count - value;
+    return ms ? ms : 0x10000;
+}
 
 Wifi::Wifi(Core *core): core(core) {
     // Set some default BB register values
@@ -29,9 +40,17 @@ Wifi::Wifi(Core *core): core(core) {
     bbRegisters[0x64] = 0xFF;
 }
 
+Wifi::~Wifi() {
+    // Clean up any remaining packet rings
+    for (uint32_t i = 0; i < rings.size(); i++)
+        delete rings[i];
+}
+
 void Wifi::saveState(FILE *file) {
     // Write state data to the file
     fwrite(&scheduled, sizeof(scheduled), 1, file);
+    fwrite(&eventCycles, sizeof(eventCycles), 1, file);
+    fwrite(&syncCycles, sizeof(syncCycles), 1, file);
     fwrite(&wModeWep, sizeof(wModeWep), 1, file);
     fwrite(&wTxstatCnt, sizeof(wTxstatCnt), 1, file);
     fwrite(&wIrf, sizeof(wIrf), 1, file);
@@ -80,6 +99,8 @@ void Wifi::saveState(FILE *file) {
 void Wifi::loadState(FILE *file) {
     // Read state data from the file
     fread(&scheduled, sizeof(scheduled), 1, file);
+    fread(&eventCycles, sizeof(eventCycles), 1, file);
+    fread(&syncCycles, sizeof(syncCycles), 1, file);
     fread(&wModeWep, sizeof(wModeWep), 1, file);
     fread(&wTxstatCnt, sizeof(wTxstatCnt), 1, file);
     fread(&wIrf, sizeof(wIrf), 1, file);
@@ -126,42 +147,172 @@ void Wifi::loadState(FILE *file) {
 }
 
 void Wifi::addConnection(Core *core) {
+    // Create packet rings for both directions of the link
+    PacketRing *ringIn = new PacketRing(&core->wifi);
+    PacketRing *ringOut = new PacketRing(this);
+
     // Add an external core to this one's connection list
+    // The mutexes only guard connection changes, so they're uncontended during packet exchange
+    // Millisecond counts are aligned with opposite offsets, so both sides agree on the current slice
+    int64_t offset = core->wifi.counters->msCount.load() - counters->msCount.load();
     mutex.lock();
-    connections.push_back(&core->wifi);
+    connections.push_back({ &core->wifi, 0, ringOut, core->wifi.counters, offset, false });
+    rings.push_back(ringIn);
     mutex.unlock();
 
     // Add this core to the external one's connection list
     core->wifi.mutex.lock();
-    core->wifi.connections.push_back(this);
+    core->wifi.connections.push_back({ this, 0, ringIn, counters, -offset, false });
+    core->wifi.rings.push_back(ringOut);
     core->wifi.mutex.unlock();
 }
 
 void Wifi::remConnection(Core *core) {
-    // Remove an external core from this one's connection list
+    // Remove an external core from this one's connection list so it stops sending to it
     mutex.lock();
-    auto position = std::find(connections.begin(), connections.end(), &core->wifi);
-    connections.erase(position);
+    for (uint32_t i = 0; i < connections.size(); i++) {
+        if (connections[i].wifi != &core->wifi) continue;
+        connections.erase(connections.begin() + i);
+        break;
+    }
     mutex.unlock();
 
-    // Remove this core from the external one's connection list
+    // Remove this core from the external one's connection list, and free the ring it was sending on
     core->wifi.mutex.lock();
-    position = std::find(core->wifi.connections.begin(), core->wifi.connections.end(), this);
-    core->wifi.connections.erase(position);
+    for (uint32_t i = 0; i < core->wifi.connections.size(); i++) {
+        if (core->wifi.connections[i].wifi != this) continue;
+        core->wifi.connections.erase(core->wifi.connections.begin() + i);
+        break;
+    }
+    for (uint32_t i = 0; i < core->wifi.rings.size(); i++) {
+        if (core->wifi.rings[i]->sender != this) continue;
+        core->wifi.counters->pending -= core->wifi.rings[i]->head - core->wifi.rings[i]->tail;
+        delete core->wifi.rings[i];
+        core->wifi.rings.erase(core->wifi.rings.begin() + i);
+        break;
+    }
     core->wifi.mutex.unlock();
+
+    // Free the ring the external core was sending on, now that it can't be written to
+    mutex.lock();
+    for (uint32_t i = 0; i < rings.size(); i++) {
+        if (rings[i]->sender != &core->wifi) continue;
+        counters->pending -= rings[i]->head - rings[i]->tail;
+        delete rings[i];
+        rings.erase(rings.begin() + i);
+        break;
+    }
+    mutex.unlock();
+}
+
+void Wifi::addRemote(uint32_t key, PacketRing *ring, WifiCounters *counters, int64_t offset) {
+    // Add a core in another process to the connection list, sending on a ring in its shared memory
+    mutex.lock();
+    connections.push_back({ nullptr, key, ring, counters, offset, false });
+    mutex.unlock();
+}
+
+void Wifi::remRemote(uint32_t key) {
+    // Remove a core in another process from the connection list
+    mutex.lock();
+    for (uint32_t i = 0; i < connections.size(); i++) {
+        if (connections[i].wifi || connections[i].remote != key) continue;
+        connections.erase(connections.begin() + i);
+        break;
+    }
+    mutex.unlock();
+}
+
+void Wifi::addRing(PacketRing *ring) {
+    // Start receiving packets on an externally managed ring
+    mutex.lock();
+    rings.push_back(ring);
+    mutex.unlock();
+}
+
+void Wifi::remRing(PacketRing *ring) {
+    // Stop receiving packets on an externally managed ring, without freeing it
+    mutex.lock();
+    auto position = std::find(rings.begin(), rings.end(), ring);
+    if (position != rings.end()) rings.erase(position);
+    mutex.unlock();
+}
+
+void Wifi::clearRing(PacketRing *ring) {
+    // Drop unread packets on an externally managed ring, while none are being received
+    mutex.lock();
+    uint32_t head = ring->head.load();
+    counters->pending -= head - ring->tail.load();
+    ring->tail.store(head);
+    mutex.unlock();
+}
+
+bool Wifi::shouldSchedule() {
+    // Check if a connection needs millisecond polling that isn't already scheduled
+    return hasConnections() && (!scheduled || eventCycles - core->globalCycles > MS_CYCLES);
 }
 
 void Wifi::scheduleInit() {
-    // Schedule an initial millisecond tick (this will reschedule itself as needed)
-    core->schedule(WIFI_COUNT_MS, MS_CYCLES);
-    scheduled = true;
+    // Bring the counters up to date and schedule the next event
+    syncCounters();
+    scheduleNext();
+}
+
+void Wifi::resetCycles() {
+    // Adjust cycle counts for a global cycle reset
+    eventCycles -= core->globalCycles;
+    syncCycles -= core->globalCycles;
 }
 
 void Wifi::countMs() {
-    // Process any queued packets
-    if (!packets.empty())
-        receivePackets();
+    // Ignore the event if it was superseded by an earlier one
+    if (!scheduled || eventCycles != core->globalCycles) return;
+    scheduled = false;
+
+    // Catch the counters up to the current millisecond
+    syncCounters();
+
+    if (hasConnections()) {
+        // Finish the last millisecond slice, and wait for connected cores to finish it in lockstep if enabled
+        counters->msCount.fetch_add(1, std::memory_order_release);
+        if (Settings::wifiLockstep)
+            syncConnections();
+
+        // Process any queued packets
+        if (counters->pending.load(std::memory_order_acquire) > 0)
+            receivePackets();
+    }
+
+    // Schedule the next event
+    scheduleNext();
+}
+
+void Wifi::syncCounters() {
+    // Get the number of whole milliseconds that have passed since the counters were last updated
+    // Counters are computed lazily from the cycle count, so they only tick when something looks at them
+    uint32_t ms = (core->globalCycles - syncCycles) / MS_CYCLES;
+    if (!ms) return;
+    syncCycles += ms * MS_CYCLES;
+    if (!wUsCountcnt && !wCmdCountcnt) return;
+
+    while (ms > 0) {
+        // Advance the counters in bulk until the next millisecond where something other than counting happens
+        uint32_t skip = std::min(ms, msUntilEvent(true)) - 1;
+        if (wUsCountcnt) {
+            wBeaconCount -= skip;
+            wUsCount += uint64_t(skip) << 10;
+            if (wPostBeacon) wPostBeacon -= skip;
+        }
+        if (wCmdCountcnt)
+            wCmdCount -= skip * CMD_STEP;
+
+        // Step through that millisecond normally
+        stepMs();
+        ms -= skip + 1;
+    }
+}
 
+void Wifi::stepMs() {
     if (wUsCountcnt) { // Counter enable
         // Decrement the beacon counter and trigger an interrupt if the pre-beacon value matches
         if (--wBeaconCount == wPreBeacon && wUsComparecnt)
@@ -184,14 +335,116 @@ void Wifi::countMs() {
     }
 
     // Decrement the CMD counter every 10 microseconds and trigger an interrupt at zero
-    if (wCmdCountcnt && (wCmdCount -= std::min<uint16_t>(0x400 / 10, wCmdCount)) == 0)
+    if (wCmdCountcnt && (wCmdCount -= std::min<uint16_t>(CMD_STEP, wCmdCount)) == 0)
         sendInterrupt(12);
+}
+
+uint32_t Wifi::msUntilEvent(bool all) {
+    // Get the milliseconds until the next counter event, or zero if there isn't one
+    // If not checking all events, only ones that trigger an enabled interrupt or a transmission are included
+    uint64_t ms = -1;
+    if (wUsCountcnt) {
+        // Check the beacon counter and compare events, which can also set up the post-beacon counter
+        bool beacon = (wTxbufLoc[BEACON_FRAME] & BIT(15)) && (wTxreqRead & BIT(BEACON_FRAME));
+        if (all || (wUsComparecnt && ((wIe & 0xE000) || beacon))) {
+            ms = std::min<uint64_t>(ms, msUntilValue(wBeaconCount, 0));
+            if (wUsComparecnt)
+                ms = std::min<uint64_t>(ms, msUntilValue(wBeaconCount, wPreBeacon));
+            uint64_t diff = wUsCompare - wUsCount;
+            if (diff && !(diff & 0x3FF))
+                ms = std::min(ms, diff >> 10);
+        }
+
+        // Check the post-beacon counter
+        if (wPostBeacon && (all || (wIe & BIT(13))))
+            ms = std::min<uint64_t>(ms, wPostBeacon);
+    }
+
+    // Check the CMD counter, which triggers every millisecond once it reaches zero
+    if (wCmdCountcnt && (all || (wIe & BIT(12))))
+        ms = std::min<uint64_t>(ms, std::max((wCmdCount + CMD_STEP - 1) / CMD_STEP, 1));
+    return (ms == uint64_t(-1)) ? 0 : std::min<uint64_t>(ms, 0xFFFFFFFF);
+}
+
+void Wifi::scheduleNext() {
+    // Poll every millisecond while connected, and otherwise wait for the next event that has an effect
+    // Far away events are split up to keep the scheduled cycle count in range
+    uint32_t ms = hasConnections() ? 1 : std::min<uint32_t>(msUntilEvent(false), MAX_MS_SKIP);
+    if (!ms) return;
+
+    // Schedule the event unless an earlier one is already pending
+    // The counters are synced, so the event always lands on a future millisecond boundary
+    uint32_t cycles = syncCycles + ms * MS_CYCLES;
+    if (scheduled && eventCycles - core->globalCycles <= cycles - core->globalCycles) return;
+    core->schedule(WIFI_COUNT_MS, cycles - core->globalCycles);
+    eventCycles = cycles;
+    scheduled = true;
+}
+
+void Wifi::syncConnections() {
+    // Wait until all connected cores have reached the same millisecond as this one
+    // Each core runs freely within a slice, so this keeps them in parallel while bounding drift
+    // Packets sent during the slice are then all queued before any of them are received
+    // The links are copied so connections can still change while waiting, without holding the mutex
+    int64_t count = counters->msCount.load(std::memory_order_relaxed);
+    mutex.lock();
+    std::vector<WifiLink> links = connections;
+    mutex.unlock();
+
+    for (uint32_t i = 0; i < links.size(); i++) {
+        WifiLink &link = links[i];
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int64_t last, current;
+        if (!readCount(link, last)) continue;
+
+        while (!link.stalled && last - link.offset < count) {
+            // Keep waiting as long as the core is progressing, even slowly when the host is oversubscribed
+            // Only stop waiting on one that hasn't advanced in a second, like when it's paused
+            // It's skipped until it catches up, which it can do freely since this one is ahead
+            std::this_thread::yield();
+            if (!readCount(link, current)) break;
+            if (current != last) {
+                last = current;
+                start = std::chrono::steady_clock::now();
+            }
+            else if (std::chrono::steady_clock::now() - start > std::chrono::seconds(1)) {
+                LOG_WARN("Instance %d lost lockstep with a connected core that stopped progressing\n", core->id);
+                link.stalled = true;
+            }
+        }
 
-    // Reschedule the task as long as something is active
-    if (!connections.empty() || wUsCountcnt || wCmdCountcnt)
-        core->schedule(WIFI_COUNT_MS, MS_CYCLES);
-    else
-        scheduled = false;
+        // Resume waiting on a stalled core once it has caught up
+        if (link.stalled && readCount(link, current) && current - link.offset >= count)
+            link.stalled = false;
+    }
+
+    // Save the stalled states on links that are still connected
+    mutex.lock();
+    for (uint32_t i = 0; i < connections.size(); i++) {
+        for (uint32_t j = 0; j < links.size(); j++) {
+            if (connections[i].wifi == links[j].wifi && connections[i].remote == links[j].remote)
+                connections[i].stalled = links[j].stalled;
+        }
+    }
+    mutex.unlock();
+}
+
+bool Wifi::readCount(WifiLink &link, int64_t &count) {
+    // Read a linked core's millisecond count if it's still connected
+    // The mutex is only held for the read, which keeps the counters from being freed while in use
+    std::lock_guard<std::mutex> guard(mutex);
+    for (uint32_t i = 0; i < connections.size(); i++) {
+        if (connections[i].wifi != link.wifi || connections[i].remote != link.remote) continue;
+        count = connections[i].counters->msCount.load(std::memory_order_acquire);
+        return true;
+    }
+    return false;
+}
+
+bool Wifi::hasConnections() {
+    // Check for connections while holding the mutex, since other threads can change them
+    std::lock_guard<std::mutex> guard(mutex);
+    return !connections.empty();
 }
 
 void Wifi::sendInterrupt(int bit) {
@@ -210,33 +463,63 @@ void Wifi::sendInterrupt(int bit) {
 }
 
 void Wifi::receivePackets() {
+    // Check if any packets are actually queued, since the pending count is only a hint
+    mutex.lock();
+    bool received = false;
+    for (uint32_t i = 0; i < rings.size(); i++)
+        received |= (rings[i]->head.load(std::memory_order_acquire) != rings[i]->tail.load(std::memory_order_relaxed));
+    if (!received) {
+        mutex.unlock();
+        return;
+    }
+
     // Start receiving packets
     sendInterrupt(6);
-    mutex.lock();
+    uint8_t *wifiRam = core->memory.getWifiRam();
+
+    // Write all queued packets to the circular buffer, in the order each link sent them
+    for (uint32_t i = 0; i < rings.size(); i++) {
+        PacketRing *ring = rings[i];
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+
+        for (; tail != head; tail++) {
+            uint8_t *data = ring->slots[tail % RING_SLOTS];
+            uint32_t size = ((U8TO16(data, 8) + 12) / 2) * 2;
+            uint32_t begin = wRxbufBegin & 0x1FFE;
+            uint32_t bufSize = (wRxbufEnd & 0x1FFE) - begin;
+
+            if (size <= bufSize && wRxbufWrcsr >= begin && wRxbufWrcsr < begin + bufSize) {
+                // Copy the packet to the circular buffer in bulk, splitting the copy if it wraps around
+                uint32_t first = std::min(size, begin + bufSize - wRxbufWrcsr);
+                memcpy(&wifiRam[wRxbufWrcsr], data, first);
+                memcpy(&wifiRam[begin], &data[first], size - first);
+                wRxbufWrcsr = begin + (wRxbufWrcsr - begin + size) % bufSize;
+            }
+            else {
+                // Fall back to writing half-words for unusual buffer setups
+                for (uint32_t j = 0; j < size; j += 2) {
+                    core->memory.write<uint16_t>(1, 0x4804000 + wRxbufWrcsr, U8TO16(data, j));
+                    wRxbufWrcsr += 2;
+                    if (int bufSize = (wRxbufEnd & 0x1FFE) - (wRxbufBegin & 0x1FFE))
+                        wRxbufWrcsr = ((wRxbufBegin & 0x1FFE) + (wRxbufWrcsr - (wRxbufBegin & 0x1FFE)) % bufSize) & 0x1FFE;
+                }
+            }
 
-    // Write all queued packets to the circular buffer
-    for (uint32_t i = 0; i < packets.size(); i++) {
-        uint16_t size = (packets[i][4] + 12) / 2;
-        for (uint32_t j = 0; j < size; j++) {
-            // Write a half-word of the packet to memory
-            core->memory.write<uint16_t>(1, 0x4804000 + wRxbufWrcsr, packets[i][j]);
-
-            // Increment the circular buffer address
-            wRxbufWrcsr += 2;
-            if (int bufSize = (wRxbufEnd & 0x1FFE) - (wRxbufBegin & 0x1FFE))
-                wRxbufWrcsr = ((wRxbufBegin & 0x1FFE) + (wRxbufWrcsr - (wRxbufBegin & 0x1FFE)) % bufSize) & 0x1FFE;
+            // Schedule a CMD reply or ack shortly after a packet is received
+            uint16_t control = U8TO16(data, 12);
+            if (control == 0x0228) // CMD frame
+                core->schedule(WIFI_TRANS_REPLY, 2048);
+            else if ((control == 0x0118 || control == 0x0158) && wCmdCount) // CMD reply
+                core->schedule(WIFI_TRANS_ACK, 2048);
+            counters->pending.fetch_sub(1, std::memory_order_relaxed);
         }
 
-        // Schedule a CMD reply or ack shortly after a packet is received
-        if (packets[i][6] == 0x0228) // CMD frame
-            core->schedule(WIFI_TRANS_REPLY, 2048);
-        else if ((packets[i][6] == 0x0118 || packets[i][6] == 0x0158) && wCmdCount) // CMD reply
-            core->schedule(WIFI_TRANS_ACK, 2048);
-        delete[] packets[i];
+        // Release the received slots back to the sender
+        ring->tail.store(tail, std::memory_order_release);
     }
 
     // Finish receiving packets
-    packets.clear();
     mutex.unlock();
     sendInterrupt(0);
 }
@@ -282,65 +565,99 @@ start:
     // Start transmitting a packet
     LOG_INFO("Instance %d sending packet of type %d with size 0x%X\n", core->id, type, size);
     sendInterrupt(7);
+
+    // Clamp the packet to the size of a ring slot, which is already larger than any valid frame
+    if (size > SLOT_SIZE) {
+        LOG_WARN("Instance %d truncating packet of size 0x%X\n", core->id, size);
+        size = SLOT_SIZE;
+    }
+
+    // Fill out the RX header
+    const uint16_t fts[] = { 0x8010, 0x801C, 0x8010, 0x8010, 0x8011, 0x801E, 0x801D };
+    uint16_t header[20] = {};
+    uint32_t headerSize = 12;
+    header[0] = fts[type]; // Frame type
+    header[1] = 0x0040; // Something?
+    header[2] = 0x0000; // Nothing
+    header[3] = 0x0010; // Transfer rate
+    header[4] = size - 12; // Data length
+    header[5] = 0x00FF; // Signal strength
+
+    if (type == CMD_ACK) {
+        // Fill out the IEEE header and body for a CMD ack
+        header[6] = 0x0218; // Frame control
+        header[7] = 0x7FFF; // Duration
+        header[8] = 0x0903; // Address 1
+        header[9] = 0x00BF; // Address 1
+        header[10] = 0x0003; // Address 1
+        header[11] = wMacaddr[0]; // Address 2
+        header[12] = wMacaddr[1]; // Address 2
+        header[13] = wMacaddr[2]; // Address 2
+        header[14] = wMacaddr[0]; // Address 3
+        header[15] = wMacaddr[1]; // Address 3
+        header[16] = wMacaddr[2]; // Address 3
+        header[17] = 0x0000; // Sequence control
+        header[18] = 0x0046; // Something?
+        header[19] = 0x0000; // Error flags
+        headerSize = 40;
+    }
+    else if (type == CMD_REPLY && !(wTxbufReply1 & BIT(15))) {
+        // Fill out the IEEE header for an empty CMD reply
+        header[6] = 0x0158; // Frame control
+        header[7] = 0x7FFF; // Duration
+        header[8] = 0x0903; // Address 1
+        header[9] = 0x00BF; // Address 1
+        header[10] = 0x0010; // Address 1
+        header[11] = wMacaddr[0]; // Address 2
+        header[12] = wMacaddr[1]; // Address 2
+        header[13] = wMacaddr[2]; // Address 2
+        header[14] = wMacaddr[0]; // Address 3
+        header[15] = wMacaddr[1]; // Address 3
+        header[16] = wMacaddr[2]; // Address 3
+        header[17] = 0x0000; // Sequence control
+        headerSize = 36;
+    }
+    else if (size > 12 && address + size <= 0x2000) {
+        // Copy the rest of the packet from memory in bulk
+        memcpy(&packet[12], &core->memory.getWifiRam()[address + 12], size - 12);
+    }
+    else {
+        // Read the rest of the packet from memory if it wraps around
+        for (uint32_t j = 12; j < size; j += 2) {
+            uint16_t value = core->memory.read<uint16_t>(1, 0x4804000 + address + j);
+            packet[j + 0] = value >> 0;
+            packet[j + 1] = value >> 8;
+        }
+    }
+
+    // Write the header to the packet LSB-first
+    for (uint32_t j = 0; j < std::min<uint32_t>(headerSize, size); j += 2) {
+        packet[j + 0] = header[j / 2] >> 0;
+        packet[j + 1] = header[j / 2] >> 8;
+    }
+
     mutex.lock();
 
     for (uint32_t i = 0; i < connections.size(); i++) {
-        // Create packet data and fill out the RX header
-        const uint16_t fts[] = { 0x8010, 0x801C, 0x8010, 0x8010, 0x8011, 0x801E, 0x801D };
-        uint16_t *data = new uint16_t[size / 2];
-        data[0] = fts[type]; // Frame type
-        data[1] = 0x0040; // Something?
-        data[2] = 0x0000; // Nothing
-        data[3] = 0x0010; // Transfer rate
-        data[4] = size - 12; // Data length
-        data[5] = 0x00FF; // Signal strength
-
-        if (type == CMD_ACK) {
-            // Fill out the IEEE header and body for a CMD ack
-            data[6] = 0x0218; // Frame control
-            data[7] = 0x7FFF; // Duration
-            data[8] = 0x0903; // Address 1
-            data[9] = 0x00BF; // Address 1
-            data[10] = 0x0003; // Address 1
-            data[11] = wMacaddr[0]; // Address 2
-            data[12] = wMacaddr[1]; // Address 2
-            data[13] = wMacaddr[2]; // Address 2
-            data[14] = wMacaddr[0]; // Address 3
-            data[15] = wMacaddr[1]; // Address 3
-            data[16] = wMacaddr[2]; // Address 3
-            data[17] = 0x0000; // Sequence control
-            data[18] = 0x0046; // Something?
-            data[19] = 0x0000; // Error flags
-        }
-        else if (type == CMD_REPLY && !(wTxbufReply1 & BIT(15))) {
-            // Fill out the IEEE header for an empty CMD reply
-            data[6] = 0x0158; // Frame control
-            data[7] = 0x7FFF; // Duration
-            data[8] = 0x0903; // Address 1
-            data[9] = 0x00BF; // Address 1
-            data[10] = 0x0010; // Address 1
-            data[11] = wMacaddr[0]; // Address 2
-            data[12] = wMacaddr[1]; // Address 2
-            data[13] = wMacaddr[2]; // Address 2
-            data[14] = wMacaddr[0]; // Address 3
-            data[15] = wMacaddr[1]; // Address 3
-            data[16] = wMacaddr[2]; // Address 3
-            data[17] = 0x0000; // Sequence control
-        }
-        else {
-            // Read the rest of the packet from memory
-            for (uint32_t j = 12; j < size; j += 2)
-                data[j / 2] = core->memory.read<uint16_t>(1, 0x4804000 + address + j);
+        // Set and update the IEEE sequence number if enabled
+        if (size >= 36 && (type >= BEACON_FRAME || !(wTxbufLoc[type] & BIT(13)))) {
+            uint16_t seqno = (wTxSeqno++) << 4;
+            packet[34] = seqno >> 0;
+            packet[35] = seqno >> 8;
         }
 
-        // Set and update the IEEE sequence number if enabled
-        if (type >= BEACON_FRAME || !(wTxbufLoc[type] & BIT(13)))
-            data[17] = (wTxSeqno++) << 4;
+        // Drop the packet if the receiver has fallen too far behind
+        PacketRing *ring = connections[i].ring;
+        uint32_t head = ring->head.load(std::memory_order_relaxed);
+        if (head - ring->tail.load(std::memory_order_acquire) >= RING_SLOTS) {
+            LOG_WARN("Instance %d dropping packet due to a full ring\n", core->id);
+            continue;
+        }
 
-        // Add the packet to the queue
-        connections[i]->mutex.lock();
-        connections[i]->packets.push_back(data);
-        connections[i]->mutex.unlock();
+        // Copy the packet into a free slot and publish it to the receiver
+        memcpy(ring->slots[head % RING_SLOTS], packet, size);
+        ring->head.store(head + 1, std::memory_order_release);
+        connections[i].counters->pending.fetch_add(1, std::memory_order_release);
     }
 
     // Finish transmitting a packet
@@ -377,12 +694,18 @@ void Wifi::writeWTxstatCnt(uint16_t mask, uint16_t value) {
 }
 
 void Wifi::writeWIrf(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to the W_IF register
     // Setting a bit actually clears it to acknowledge an interrupt
     wIrf &= ~(value & mask);
 }
 
 void Wifi::writeWIe(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Trigger a WiFi interrupt if W_IF & W_IE changes from zero
     if (!(wIe & wIrf) && (value & mask & wIrf))
         core->interpreter[1].sendInterrupt(24);
@@ -390,6 +713,9 @@ void Wifi::writeWIe(uint16_t mask, uint16_t value) {
     // Write to the W_IE register
     mask &= 0xFBFF;
     wIe = (wIe & ~mask) | (value & mask);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWMacaddr(int index, uint16_t mask, uint16_t value) {
@@ -524,21 +850,33 @@ void Wifi::writeWTxbufGapdisp(uint16_t mask, uint16_t value) {
 }
 
 void Wifi::writeWTxbufLoc(PacketType type, uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to one of the W_TXBUF_[BEACON,CMD,LOC1,LOC2,LOC3] registers
     wTxbufLoc[type] = (wTxbufLoc[type] & ~mask) | (value & mask);
 
     // Send a packet to connected cores if triggered for non-beacons
     if (type != BEACON_FRAME && (wTxbufLoc[type] & BIT(15)) && (wTxreqRead & BIT(type)))
         transmitPacket(type);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWBeaconInt(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to the W_BEACON_INT register
     mask &= 0x03FF;
     wBeaconInt = (wBeaconInt & ~mask) | (value & mask);
 
     // Reload the beacon millisecond counter
     wBeaconCount = wBeaconInt;
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWTxbufReply1(uint16_t mask, uint16_t value) {
@@ -547,12 +885,21 @@ void Wifi::writeWTxbufReply1(uint16_t mask, uint16_t value) {
 }
 
 void Wifi::writeWTxreqReset(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Clear bits in W_TXREQ_READ
     mask &= 0x000F;
     wTxreqRead &= ~(value & mask);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWTxreqSet(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Set bits in W_TXREQ_READ
     mask &= 0x000F;
     wTxreqRead |= (value & mask);
@@ -561,15 +908,27 @@ void Wifi::writeWTxreqSet(uint16_t mask, uint16_t value) {
     for (int i = 0; i < 4; i++)
         if ((wTxbufLoc[i] & BIT(15)) && (wTxreqRead & BIT(i)))
             transmitPacket(PacketType(i));
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWUsCountcnt(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to the W_US_COUNTCNT register
     mask &= 0x0001;
     wUsCountcnt = (wUsCountcnt & ~mask) | (value & mask);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWUsComparecnt(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to the W_US_COMPARECNT register
     mask &= 0x0001;
     wUsComparecnt = (wUsComparecnt & ~mask) | (value & mask);
@@ -577,40 +936,79 @@ void Wifi::writeWUsComparecnt(uint16_t mask, uint16_t value) {
     // Trigger an immediate beacon interrupt if requested
     if (value & BIT(1))
         sendInterrupt(14);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWCmdCountcnt(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to the W_CMD_COUNTCNT register
     mask &= 0x0001;
     wCmdCountcnt = (wCmdCountcnt & ~mask) | (value & mask);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWUsCompare(int index, uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to part of the W_US_COMPARE register
     int shift = index * 16;
     mask &= (index ? 0xFFFF : 0xFC00);
     wUsCompare = (wUsCompare & ~(uint64_t(mask) << shift)) | (uint64_t(value & mask) << shift);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWUsCount(int index, uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to part of the W_US_COUNT register
     int shift = index * 16;
     wUsCount = (wUsCount & ~(uint64_t(mask) << shift)) | (uint64_t(value & mask) << shift);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWPreBeacon(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to the W_PRE_BEACON register
     wPreBeacon = (wPreBeacon & ~mask) | (value & mask);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWCmdCount(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to the W_CMD_COUNT register
     wCmdCount = (wCmdCount & ~mask) | (value & mask);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWBeaconCount(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to the W_BEACON_COUNT register
     wBeaconCount = (wBeaconCount & ~mask) | (value & mask);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWConfig(int index, uint16_t mask, uint16_t value) {
@@ -626,8 +1024,14 @@ void Wifi::writeWConfig(int index, uint16_t mask, uint16_t value) {
 }
 
 void Wifi::writeWPostBeacon(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Write to the W_POST_BEACON register
     wPostBeacon = (wPostBeacon & ~mask) | (value & mask);
+
+    // Reschedule counter events based on the new state
+    scheduleNext();
 }
 
 void Wifi::writeWBbCnt(uint16_t mask, uint16_t value) {
@@ -653,6 +1057,9 @@ void Wifi::writeWBbWrite(uint16_t mask, uint16_t value) {
 }
 
 void Wifi::writeWIrfSet(uint16_t mask, uint16_t value) {
+    // Catch up the counters before modifying state
+    syncCounters();
+
     // Trigger a WiFi interrupt if W_IF & W_IE changes from zero
     if (!(wIe & wIrf) && (wIe & value & mask))
         core->interpreter[1].sendInterrupt(24);
@@ -19,12 +19,49 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <cstdio>
 #include <mutex>
 #include <vector>
 
+// Preallocated packet slots per link, with room for the largest possible frame
+#define RING_SLOTS 32
+#define SLOT_SIZE 0x1000
+
 class Core;
+class Wifi;
+
+// Single-producer single-consumer queue of packets sent over one link
+// The sending core only advances the head, and the receiving core only advances the tail
+struct PacketRing {
+    Wifi *sender;
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    uint8_t slots[RING_SLOTS][SLOT_SIZE];
+
+    PacketRing(Wifi *sender = nullptr): sender(sender), head(0), tail(0) {}
+};
+
+// Counters that connected cores access, which can be placed in shared memory for remote links
+struct WifiCounters {
+    std::atomic<int> pending;
+    std::atomic<int64_t> msCount;
+
+    WifiCounters(): pending(0), msCount(0) {}
+};
+
+// Outgoing connection to another core, along with the ring it receives this core's packets on
+// Local links point to the other core, while remote links are identified by a key instead
+// The offset aligns the other core's millisecond count with this one's for lockstep
+struct WifiLink {
+    Wifi *wifi;
+    uint32_t remote;
+    PacketRing *ring;
+    WifiCounters *counters;
+    int64_t offset;
+    bool stalled;
+};
 
 enum PacketType {
     LOC1_FRAME,
@@ -39,20 +76,30 @@ enum PacketType {
 class Wifi {
 public:
     Wifi(Core *core);
+    ~Wifi();
     void saveState(FILE *file);
     void loadState(FILE *file);
 
     void addConnection(Core *core);
     void remConnection(Core *core);
+    void addRemote(uint32_t key, PacketRing *ring, WifiCounters *counters, int64_t offset);
+    void remRemote(uint32_t key);
+    void addRing(PacketRing *ring);
+    void remRing(PacketRing *ring);
+    void clearRing(PacketRing *ring);
+
+    WifiCounters *getCounters() { return counters; }
+    void setCounters(WifiCounters *counters) { this->counters = counters ? counters : &localCounters; }
 
-    bool shouldSchedule() { return (!connections.empty() || wUsCountcnt) && !scheduled; }
+    bool shouldSchedule();
     void scheduleInit();
+    void resetCycles();
     void countMs();
     void transmitPacket(PacketType type);
 
     uint16_t readWModeWep() { return wModeWep; }
     uint16_t readWTxstatCnt() { return wTxstatCnt; }
-    uint16_t readWIrf() { return wIrf; }
+    uint16_t readWIrf() { syncCounters(); return wIrf; }
     uint16_t readWIe() { return wIe; }
     uint16_t readWMacaddr(int index) { return wMacaddr[index]; }
     uint16_t readWBssid(int index) { return wBssid[index]; }
@@ -77,18 +124,18 @@ public:
     uint16_t readWBeaconInt() { return wBeaconInt; }
     uint16_t readWTxbufReply1() { return wTxbufReply1; }
     uint16_t readWTxbufReply2() { return wTxbufReply2; }
-    uint16_t readWTxreqRead() { return wTxreqRead; }
+    uint16_t readWTxreqRead() { syncCounters(); return wTxreqRead; }
     uint16_t readWTxstat() { return wTxstat; }
     uint16_t readWUsCountcnt() { return wUsCountcnt; }
     uint16_t readWUsComparecnt() { return wUsComparecnt; }
     uint16_t readWCmdCountcnt() { return wCmdCountcnt; }
     uint16_t readWUsCompare(int index) { return wUsCompare >> (index * 16); }
-    uint16_t readWUsCount(int index) { return wUsCount >> (index * 16); }
+    uint16_t readWUsCount(int index) { syncCounters(); return wUsCount >> (index * 16); }
     uint16_t readWPreBeacon() { return wPreBeacon; }
-    uint16_t readWCmdCount() { return wCmdCount; }
-    uint16_t readWBeaconCount() { return wBeaconCount; }
+    uint16_t readWCmdCount() { syncCounters(); return wCmdCount; }
+    uint16_t readWBeaconCount() { syncCounters(); return wBeaconCount; }
     uint16_t readWConfig(int index) { return wConfig[index]; }
-    uint16_t readWPostBeacon() { return wPostBeacon; }
+    uint16_t readWPostBeacon() { syncCounters(); return wPostBeacon; }
     uint16_t readWBbRead() { return wBbRead; }
     uint16_t readWTxSeqno() { return wTxSeqno; }
     uint16_t readWRxbufRdData();
@@ -137,10 +184,15 @@ public:
 
 private:
     Core *core;
-    std::vector<Wifi*> connections;
-    std::vector<uint16_t*> packets;
+    std::vector<WifiLink> connections;
+    std::vector<PacketRing*> rings;
+    WifiCounters localCounters;
+    WifiCounters *counters = &localCounters;
     std::mutex mutex;
+    uint8_t packet[SLOT_SIZE] = {};
     bool scheduled = false;
+    uint32_t eventCycles = 0;
+    uint32_t syncCycles = 0;
 
     uint16_t wModeWep = 0;
     uint16_t wTxstatCnt = 0;
@@ -192,5 +244,12 @@ private:
     };
 
     void sendInterrupt(int bit);
+    void syncCounters();
+    void stepMs();
+    uint32_t msUntilEvent(bool all);
+    void scheduleNext();
+    void syncConnections();
+    bool readCount(WifiLink &link, int64_t &count);
+    bool hasConnections();
     void receivePackets();
 };
@@ -0,0 +1,290 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+#include "core.h"
+
+#ifdef REMOTE_WIFI
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Marks a slot as being claimed, before the sender has finished setting it up
+#define SLOT_CLAIMING 0xFFFFFFFF
+
+// Number of missed heartbeats before a remote core is considered gone
+#define MAX_MISSED 5
+
+#ifdef REMOTE_WIFI
+// Mailboxes are shared between processes, which only works for atomics that don't need a lock
+static_assert(sizeof(int64_t) == sizeof(long long) && ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+    "Remote WiFi needs lock-free atomics");
+#endif
+
+WifiRemote::WifiRemote(Core *core): core(core) {
+#ifdef REMOTE_WIFI
+    if (!Settings::wifiRemote) return;
+
+    // Generate a key unique to this core, with a random process tag in the upper bits
+    // Process IDs aren't used since they can collide across containers
+    static uint32_t tag = std::random_device()() % 0xFFFFFE + 1;
+    key = (tag << 8) | (core->id & 0xFF);
+
+    // Create and map the mailbox that other processes send packets to
+    listPath = Settings::wifiRendezvous != "" ? Settings::wifiRendezvous : (Settings::basePath + "/noods-wifi.lst");
+    int fd = open(mailboxPath(key).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0 || ftruncate(fd, sizeof(RemoteMailbox)) < 0) {
+        LOG_WARN("Failed to create WiFi mailbox for cross-process links\n");
+        if (fd >= 0) close(fd);
+        return;
+    }
+    void *data = mmap(nullptr, sizeof(RemoteMailbox), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return;
+    mailbox = new (data) RemoteMailbox();
+
+    // Route this core's shared counters and inbound rings through the mailbox
+    // This happens before any local connections are made, since they copy the counter pointer
+    core->wifi.setCounters(&mailbox->counters);
+    for (int i = 0; i < MAX_REMOTE; i++)
+        core->wifi.addRing(&mailbox->slots[i].ring);
+
+    // Advertise the mailbox in the rendezvous file, and start the thread that links with other processes
+    updateList(1, key);
+    LOG_INFO("Instance %d advertising WiFi mailbox %08X\n", core->id, key);
+    thread = std::thread(&WifiRemote::runWorker, this);
+#endif
+}
+
+WifiRemote::~WifiRemote() {
+#ifdef REMOTE_WIFI
+    if (!mailbox) return;
+
+    // Stop the worker thread if it was started
+    if (thread.joinable()) {
+        mutex.lock();
+        stopping = true;
+        cond.notify_one();
+        mutex.unlock();
+        thread.join();
+    }
+
+    // Stop advertising the mailbox and unlink from all remote cores
+    updateList(-1, key);
+    while (!peers.empty())
+        disconnPeer(peers.size() - 1);
+
+    // Detach the mailbox from the WiFi state and remove it
+    for (int i = 0; i < MAX_REMOTE; i++)
+        core->wifi.remRing(&mailbox->slots[i].ring);
+    core->wifi.setCounters(nullptr);
+    munmap(mailbox, sizeof(RemoteMailbox));
+    unlink(mailboxPath(key).c_str());
+#endif
+}
+
+std::string WifiRemote::mailboxPath(uint32_t key) {
+    // Place mailboxes next to the rendezvous file, named by their keys
+    char name[32];
+    snprintf(name, sizeof(name), ".%08X.mbx", key);
+    return listPath + name;
+}
+
+std::vector<uint32_t> WifiRemote::updateList(int change, uint32_t target) {
+    // Read the keys of advertised mailboxes from the rendezvous file, optionally adding or removing one
+    std::vector<uint32_t> keys;
+#ifdef REMOTE_WIFI
+    int fd = open(listPath.c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd < 0) return keys;
+    flock(fd, change ? LOCK_EX : LOCK_SH);
+
+    // Parse a key from each line of the file
+    std::string text;
+    char buffer[256];
+    ssize_t count;
+    while ((count = read(fd, buffer, sizeof(buffer))) > 0)
+        text.append(buffer, count);
+    for (size_t i = 0; i < text.size();) {
+        size_t end = text.find('\n', i);
+        if (end == std::string::npos) end = text.size();
+        uint32_t value = strtoul(text.substr(i, end - i).c_str(), nullptr, 16);
+        if (value && (change >= 0 || value != target)) keys.push_back(value);
+        i = end + 1;
+    }
+
+    if (change) {
+        // Rewrite the file with the mailbox added or removed
+        if (change > 0 && std::find(keys.begin(), keys.end(), target) == keys.end())
+            keys.push_back(target);
+        text = "";
+        for (size_t i = 0; i < keys.size(); i++) {
+            snprintf(buffer, sizeof(buffer), "%08X\n", keys[i]);
+            text += buffer;
+        }
+        if (ftruncate(fd, 0) == 0 && lseek(fd, 0, SEEK_SET) == 0 && write(fd, text.c_str(), text.size()) < 0)
+            LOG_WARN("Failed to update the WiFi rendezvous file\n");
+    }
+
+    flock(fd, LOCK_UN);
+    close(fd);
+#endif
+    return keys;
+}
+
+void WifiRemote::update() {
+    // Signal that this core is still running, and check for remote cores to link with about once a second
+    // The rendezvous file and mailboxes are accessed on the worker thread, so file access doesn't stall emulation
+    if (!mailbox || ++frames < 60) return;
+    frames = 0;
+    mailbox->heartbeat++;
+    mutex.lock();
+    pending = true;
+    cond.notify_one();
+    mutex.unlock();
+}
+
+void WifiRemote::runWorker() {
+    std::unique_lock<std::mutex> guard(mutex);
+    while (true) {
+        // Sleep until the core signals a check, or until stopping
+        cond.wait(guard, [&] { return pending || stopping; });
+        if (stopping) return;
+        pending = false;
+        guard.unlock();
+        discover();
+        guard.lock();
+    }
+}
+
+void WifiRemote::discover() {
+    // Get the advertised mailboxes
+    std::vector<uint32_t> keys = updateList(0, 0);
+
+    // Advertise the mailbox again if another core pruned it, like after this one was paused
+    if (std::find(keys.begin(), keys.end(), key) == keys.end())
+        keys = updateList(1, key);
+
+    // Unlink from remote cores that are gone, stopped updating, or released this core's slot
+    for (int i = peers.size() - 1; i >= 0; i--) {
+        RemotePeer &peer = peers[i];
+        uint32_t heartbeat = peer.mailbox->heartbeat.load();
+        peer.missed = (heartbeat == peer.heartbeat) ? (peer.missed + 1) : 0;
+        peer.heartbeat = heartbeat;
+
+        // Prune a core that stopped updating from the rendezvous file, so a crashed one isn't relinked forever
+        if (peer.missed >= MAX_MISSED) {
+            keys = updateList(-1, peer.key);
+            disconnPeer(i);
+        }
+        else if (std::find(keys.begin(), keys.end(), peer.key) == keys.end() ||
+                peer.mailbox->slots[peer.slot].sender.load() != key) {
+            disconnPeer(i);
+        }
+    }
+
+    // Release inbound slots held by cores that are no longer advertised
+    for (int i = 0; i < MAX_REMOTE; i++) {
+        uint32_t sender = mailbox->slots[i].sender.load();
+        if (sender && sender != SLOT_CLAIMING && std::find(keys.begin(), keys.end(), sender) == keys.end())
+            freeSlots(sender);
+    }
+
+    // Link with newly advertised cores, skipping this process since its cores are linked directly
+    for (size_t i = 0; i < keys.size(); i++) {
+        if ((keys[i] >> 8) == (key >> 8)) continue;
+        bool linked = false;
+        for (size_t j = 0; j < peers.size(); j++)
+            linked |= (peers[j].key == keys[i]);
+        if (!linked) connectPeer(keys[i]);
+    }
+}
+
+void WifiRemote::connectPeer(uint32_t key) {
+#ifdef REMOTE_WIFI
+    // Map the remote core's mailbox, pruning its key if the mailbox no longer exists
+    int fd = open(mailboxPath(key).c_str(), O_RDWR);
+    if (fd < 0) {
+        updateList(-1, key);
+        return;
+    }
+    void *data = mmap(nullptr, sizeof(RemoteMailbox), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return;
+    RemoteMailbox *remote = (RemoteMailbox*)data;
+
+    // Use the lockstep offset the remote core chose if it linked first, so both sides agree
+    int64_t offset = remote->counters.msCount.load() - mailbox->counters.msCount.load();
+    for (int i = 0; i < MAX_REMOTE; i++) {
+        if (mailbox->slots[i].sender.load() == key)
+            offset = mailbox->slots[i].offset.load();
+    }
+
+    // Claim an inbound slot in the remote mailbox, reusing one still held from an earlier link
+    // The remote core is passed the opposite offset so lockstep agrees on both sides
+    for (int i = 0; i < MAX_REMOTE * 2; i++) {
+        RemoteSlot &slot = remote->slots[i % MAX_REMOTE];
+        uint32_t expected = (i < MAX_REMOTE) ? this->key : 0;
+        if (!slot.sender.compare_exchange_strong(expected, SLOT_CLAIMING)) continue;
+        slot.offset.store(-offset);
+        slot.sender.store(this->key, std::memory_order_release);
+
+        // Start sending packets on the claimed ring
+        core->wifi.addRemote(key, &slot.ring, &remote->counters, offset);
+        peers.push_back({ key, remote, i % MAX_REMOTE, remote->heartbeat.load(), 0 });
+        LOG_INFO("Instance %d linked with remote WiFi mailbox %08X\n", core->id, key);
+        return;
+    }
+
+    // Give up if the remote mailbox is full
+    LOG_WARN("Remote WiFi mailbox %08X has no free slots\n", key);
+    munmap(remote, sizeof(RemoteMailbox));
+#endif
+}
+
+void WifiRemote::disconnPeer(int index) {
+#ifdef REMOTE_WIFI
+    // Stop sending to the remote core
+    // Its slot is left for the remote core to release, since only it can safely drop unread packets
+    RemotePeer &peer = peers[index];
+    core->wifi.remRemote(peer.key);
+    munmap(peer.mailbox, sizeof(RemoteMailbox));
+
+    // Release the slot the remote core was sending on
+    LOG_INFO("Instance %d unlinked from remote WiFi mailbox %08X\n", core->id, peer.key);
+    freeSlots(peer.key);
+    peers.erase(peers.begin() + index);
+#endif
+}
+
+void WifiRemote::freeSlots(uint32_t key) {
+    // Drop any unread packets from a remote core and make its inbound slot available again
+    // The packets are dropped through the WiFi state, so it doesn't race with receiving them
+    for (int i = 0; i < MAX_REMOTE; i++) {
+        RemoteSlot &slot = mailbox->slots[i];
+        if (slot.sender.load() != key) continue;
+        core->wifi.clearRing(&slot.ring);
+        slot.sender.store(0);
+    }
+}
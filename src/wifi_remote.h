@@ -0,0 +1,98 @@
+/*
+    Copyright 2019-2025 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "wifi.h"
+
+// Cross-process links rely on POSIX file mapping and locking, and on atomics that work in shared memory
+// Atomics that aren't lock-free use a lock local to the process, so targets without them can't link
+#if !defined(WINDOWS) && !defined(_WIN32) && !defined(__SWITCH__) && !defined(__vita__) && !defined(__WIIU__) && \
+    ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2
+#define REMOTE_WIFI
+#endif
+
+// Number of cores in other processes that can send to this one
+#define MAX_REMOTE 7
+
+class Core;
+
+// Inbound ring that a core in another process claims by writing its key
+struct RemoteSlot {
+    std::atomic<uint32_t> sender;
+    std::atomic<int64_t> offset;
+    PacketRing ring;
+
+    RemoteSlot(): sender(0), offset(0) {}
+};
+
+// Shared memory that other processes map to send packets to a core
+struct RemoteMailbox {
+    std::atomic<uint32_t> heartbeat;
+    WifiCounters counters;
+    RemoteSlot slots[MAX_REMOTE];
+
+    RemoteMailbox(): heartbeat(0) {}
+};
+
+struct RemotePeer {
+    uint32_t key;
+    RemoteMailbox *mailbox;
+    int slot;
+    uint32_t heartbeat;
+    int missed;
+};
+
+class WifiRemote {
+public:
+    WifiRemote(Core *core);
+    ~WifiRemote();
+
+    void update();
+
+private:
+    Core *core;
+    uint32_t key = 0;
+    std::string listPath;
+    RemoteMailbox *mailbox = nullptr;
+    std::vector<RemotePeer> peers;
+    int frames = 0;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool pending = false;
+    bool stopping = false;
+
+    void runWorker();
+    void discover();
+    std::string mailboxPath(uint32_t key);
+    std::vector<uint32_t> updateList(int change, uint32_t target);
+    void connectPeer(uint32_t key);
+    void disconnPeer(int index);
+    void freeSlots(uint32_t key);
+};